@@ -0,0 +1,745 @@
+import libpe;
+
+#include "c2m.hpp"
+#include "canonical.hpp"
+#include "indexer.hpp"
+
+#include <format>
+#include <algorithm>
+#include <cctype>
+#include <json/json.h>
+
+std::string RunCmd(const std::string& cmd)
+{
+	FILE* fp;
+	char buffer[1024]; // lazy mode runs this from several threads
+	std::string result;
+	if ((fp = _popen(cmd.c_str(), "r")) == NULL)
+		throw std::exception{ "failed to generate process pipe." };
+
+	memset(buffer, 0, 1024);
+	while (fgets(buffer, 1022, fp) != NULL)
+	{
+		result += buffer;
+		result.push_back('\n');
+	}
+
+	if (_pclose(fp) == -1)
+		throw std::exception{ "failed to close process pipe." };
+
+	return result;
+}
+
+bool HaveSubString(const std::string& parentString, const std::string& subString)
+{
+	return parentString.find(subString) != std::string::npos;
+}
+
+bool SearchAllSubStrings(const std::string& string, const std::regex& pattern, std::vector<std::string>& results)
+{
+	results.clear();
+
+	std::smatch match{};
+	std::string::const_iterator begin(string.cbegin());
+
+	while (std::regex_search(begin, string.cend(), match, pattern))
+	{
+		results.push_back(match.str());
+		begin = match.suffix().first;
+	}
+	return !results.empty();
+}
+
+std::string FindLastMatch(const std::string& input, const std::regex& pattern) {
+	std::smatch match;
+	size_t lastPos = 0;
+	std::string lastMatch;
+
+	while (std::regex_search(input.begin() + lastPos, input.end(), match, pattern)) {
+		lastMatch = match[0];
+		lastPos += match.position(0) + match.length(0);
+	}
+
+	return lastMatch; 
+}
+
+void ReplaceSubstring(std::string& str, const std::string& toReplace, const std::string& replacement) {
+	size_t pos = 0;
+	while ((pos = str.find(toReplace, pos)) != std::string::npos) {
+		str.replace(pos, toReplace.length(), replacement);
+		pos += replacement.length(); // ƶһλ
+	}
+}
+
+std::string RemoveAngleBrackets(const std::string& string)
+{
+	std::string result{ string };
+	int level = 0;
+	size_t bracket;
+	std::vector<std::string> brackets{};
+
+	for (size_t i = 0; i < string.size(); i++)
+	{
+		if (string[i] == '<')
+		{
+			if (level == 0)
+			{
+				bracket = i;
+			}
+			level++;
+		}
+		if (string[i] == '>')
+		{
+			level--;
+			if (level == 0)
+			{
+				brackets.push_back(string.substr(bracket, i - bracket + 1));
+			}
+		}
+	}
+
+
+	for (auto& i : brackets)
+	{
+		ReplaceSubstring(result, i, "");
+	}
+	return result;
+}
+
+void ReadTypeIndex(const Json::Value& value, c2m::TypeIndex& index, size_t exportCount)
+{
+	for (auto it = value.begin(); it != value.end(); it++)
+	{
+		std::vector<size_t>& exports = index[it.name()];
+		for (auto& i : *it)
+		{
+			if (i.asUInt64() >= exportCount)
+				throw std::exception{ "type index of cache file is out of range." };
+			exports.push_back(i.asUInt64());
+		}
+	}
+}
+
+namespace c2m
+{
+	std::vector<Export> ReadExportTable(const std::filesystem::path& path)
+	{
+		libpe::Clibpe pe;
+		if (pe.OpenFile(path.c_str()) != libpe::PEOK)
+			throw std::exception{ "failed to parse the target PE file." };
+
+		const auto exports = pe.GetExport();
+
+		if (!exports) 
+			throw std::exception{ "target file does not have exports." };
+
+		std::vector<Export> table{};
+		table.reserve(exports.value().vecFuncs.size());
+		for (auto& i : exports.value().vecFuncs)
+		{
+			table.push_back(
+				{
+					i.dwOrdinal,
+					i.dwFuncRVA,
+					i.strFuncName,
+					"",
+					DeclarationDetails{}
+				}
+			);
+		}
+		return table;
+	}
+
+	std::string State::SimplifyDeclaration(const std::string& declaration)
+	{
+		std::string simplified{ declaration };
+
+		simplified = std::regex_replace(simplified, std::regex{ R"((public|private|protected): )" }, "");
+		simplified = std::regex_replace(simplified, std::regex{ R"((static|virtual) )" }, "");
+		simplified = std::regex_replace(simplified, std::regex{ R"((__\w+call|__cdecl))" }, ""); // to prevent like __cdecl* __cdecl
+		simplified = std::regex_replace(simplified, std::regex{ R"(  )" }, " ");
+
+		simplified = std::regex_replace(simplified, std::regex{ R"((class|struct) )" }, "");
+		simplified = std::regex_replace(simplified, std::regex{ R"( >)" }, ">");
+		simplified = std::regex_replace(simplified, std::regex{ R"( \&)" }, "&");
+		simplified = std::regex_replace(simplified, std::regex{ R"( \*)" }, "*");
+		simplified = std::regex_replace(simplified, std::regex{ R"(\)const )" }, ") const");
+
+		simplified = std::regex_replace(simplified, std::regex{ R"(`vftable')" }, "vftable");
+		simplified = std::regex_replace(simplified, std::regex{ R"(`vbtable')" }, "vbtable");
+		simplified = std::regex_replace(simplified, std::regex{ R"(`default constructor closure')" }, "default_constructor_closure");
+		simplified = std::regex_replace(simplified, std::regex{ R"(`vbase destructor')" }, "vbase_destructor");
+		simplified = std::regex_replace(simplified, std::regex{ R"(`|')" }, "");
+		simplified = std::regex_replace(simplified, std::regex{ R"( __ptr64)" }, "");
+
+		simplified = std::regex_replace(simplified, std::regex{ R"(\{.+\})" }, "");
+
+		if (simplified[0] == ' ')
+			simplified = simplified.substr(1);
+
+		return simplified;
+	}
+
+	void State::GenerateCacheFile()
+	{
+		LoadExportsFromPEFile();
+		BuildTypeIndex(m_exports, m_takesIndex, m_returnsIndex);
+		SaveToCacheFile();
+	}
+
+	void State::SaveToCacheFile()
+	{
+		// the module is loaded by now, a cache that can't be written only costs the next run
+		try
+		{
+			std::filesystem::create_directories(m_cacheDirectory);
+			SaveExportsToCacheFile(m_cachePath, m_exports, m_takesIndex, m_returnsIndex);
+		}
+		catch (const std::exception& err)
+		{
+			Log(std::format("failed to write cache file {}: {}", m_cachePath.string(), err.what()));
+		}
+	}
+
+	void State::BuildTypeIndex(const std::vector<Export>& exports, TypeIndex& takes, TypeIndex& returns)
+	{
+		takes.clear();
+		returns.clear();
+
+		std::string returnType{};
+		std::vector<std::string> parameterTypes{};
+		for (size_t i = 0; i < exports.size(); i++)
+		{
+			if (!CanonicalizeSignature(exports[i].ClearDeclaration, returnType, parameterTypes))
+				continue;
+
+			if (!returnType.empty())
+				returns[returnType].push_back(i);
+
+			for (auto& type : parameterTypes)
+			{
+				// f(int,int) is listed once under int
+				std::vector<size_t>& indices = takes[type];
+				if (indices.empty() || indices.back() != i)
+					indices.push_back(i);
+			}
+		}
+	}
+
+	void State::SaveExportsToCacheFile(const std::filesystem::path& path, const std::vector<Export>& exports)
+	{
+		TypeIndex takes{};
+		TypeIndex returns{};
+		BuildTypeIndex(exports, takes, returns);
+		SaveExportsToCacheFile(path, exports, takes, returns);
+	}
+
+	void State::SaveExportsToCacheFile(const std::filesystem::path& path, const std::vector<Export>& exports, const TypeIndex& takes, const TypeIndex& returns)
+	{
+		std::ofstream file;
+		file.open(path);
+
+		if (!file.is_open())
+			throw std::exception{ "failed to open cache file." };
+
+		Json::Value root;
+		root["exports"] = Json::Value{ Json::arrayValue };
+
+		for (auto& i : exports)
+		{
+			Json::Value exp;
+			exp["ordinal"] = i.Ordinal;
+			exp["rva"] = i.Rva;
+			exp["mangled_declaration"] = i.MangledDeclaration;
+			exp["clear_declaration"] = i.ClearDeclaration;
+			exp["canonical_hash"] = Json::UInt64(i.CanonicalHash);
+
+			exp["declaration_details"] = Json::Value{};
+			exp["declaration_details"]["c_function"] = i.DeclarationDetails.CFunction;
+			exp["declaration_details"]["variable"] = i.DeclarationDetails.Variable;
+			exp["declaration_details"]["constructor_function"] = i.DeclarationDetails.ConstructorFunction;
+			exp["declaration_details"]["destructor_function"] = i.DeclarationDetails.DestructorFunction;
+
+			exp["declaration_details"]["name"] = i.DeclarationDetails.Name;
+			exp["declaration_details"]["parentheses_pairs"] = Json::Value{};
+			for (auto& j : i.DeclarationDetails.ParenthesesPairs)
+				exp["declaration_details"]["parentheses_pairs"].append(j);
+
+			root["exports"].append(exp);
+		}
+
+		// type -> export indices, so --takes / --returns never scan the exports
+		auto writeTypeIndex = [](const TypeIndex& index)
+			{
+				Json::Value value{ Json::objectValue };
+				for (auto& [type, indices] : index)
+				{
+					Json::Value& exports = value[type];
+					exports = Json::Value{ Json::arrayValue };
+					for (size_t i : indices)
+						exports.append(Json::UInt64(i));
+				}
+				return value;
+			};
+		root["canonical_version"] = CanonicalVersion;
+		root["takes"] = writeTypeIndex(takes);
+		root["returns"] = writeTypeIndex(returns);
+
+		file << root.toStyledString() << std::endl;
+		file.close();
+	}
+
+	void State::LoadExportTableFromPEFile()
+	{
+		m_exports = ReadExportTable(m_filePath);
+	}
+
+	void State::LoadExportsFromPEFile()
+	{
+		LoadExportTableFromPEFile();
+
+		Log("c2m is generating cache file, this may take some time...");
+
+		for (auto& i : m_exports)
+			DemangleExport(i);
+	}
+
+	void State::DemangleExport(Export& exp)
+	{
+		std::string cmd = "undname.exe " + exp.MangledDeclaration;
+
+		std::string result = RunCmd(cmd);
+		size_t pos = result.find("is :- \"");
+		exp.ClearDeclaration = SimplifyDeclaration(std::string{ result.substr(pos + 7, result.find_last_of('\"') - pos - 7) });
+		ParseDeclarationDetails(exp.ClearDeclaration, exp.DeclarationDetails);
+		exp.CanonicalHash = HashCanonicalDeclaration(CanonicalizeDeclaration(exp.ClearDeclaration));
+	}
+
+	void State::GenerateCacheFileInBackground()
+	{
+		LoadExportTableFromPEFile();
+
+		Log("c2m is generating cache file in background...");
+
+		m_demangled = std::make_unique<std::once_flag[]>(m_exports.size());
+		m_indexer = std::jthread{ [this]()
+			{
+				try
+				{
+					for (size_t i = 0; i < m_exports.size(); i++)
+						EnsureDemangled(i);
+
+					BuildTypeIndex(m_exports, m_takesIndex, m_returnsIndex);
+					BuildDatabase();
+					m_indexed.store(true, std::memory_order_release);
+				}
+				catch (const std::exception& err)
+				{
+					Log(std::format("failed to demangle the exports: {}", err.what()));
+					return;
+				}
+
+				SaveToCacheFile();
+			} };
+	}
+
+	void State::EnsureDemangled(size_t index)
+	{
+		if (m_demangled)
+			std::call_once(m_demangled[index], [&]() { DemangleExport(m_exports[index]); });
+	}
+
+	bool State::IsFullyLoaded() const
+	{
+		return !m_demangled || m_indexed.load(std::memory_order_acquire);
+	}
+
+	void State::CollectCandidates(const DeclarationDetails& details, std::vector<size_t>& candidates)
+	{
+		// msvc puts the unqualified identifier first: ?clear@..., ??0basic_ios@... (ctor), ??1 (dtor), ??$ (template)
+		// so the parsed name always shows up literally in those mangled names and a substring test is a safe prefilter.
+		// other ?? names (operators, vftables, `string', ...) get their name from undname, always demangle them
+		std::string_view key{ details.Name };
+		if (!key.empty() && key[0] == '~')
+			key.remove_prefix(1);
+
+		bool identifier = !key.empty() && std::all_of(key.begin(), key.end(), [](char c)
+			{
+				return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '@';
+			});
+
+		candidates.clear();
+		for (size_t i = 0; i < m_exports.size(); i++)
+		{
+			const std::string& mangled = m_exports[i].MangledDeclaration;
+
+			if (!identifier)
+				candidates.push_back(i);
+			else if (mangled.size() > 2 && mangled[0] == '?' && mangled[1] == '?' && mangled[2] != '0' && mangled[2] != '1' && mangled[2] != '$')
+				candidates.push_back(i);
+			else if (mangled.find(key) != std::string::npos)
+				candidates.push_back(i);
+		}
+	}
+
+	void State::LoadExportsFromCacheFile()
+	{
+		std::ifstream file;
+		file.open(m_cachePath);
+
+		if (!file.is_open())
+			throw std::exception{ "failed to open cache file." };
+
+		Json::Reader reader;
+		Json::Value root;
+
+		if (!reader.parse(file, root, false))
+			throw std::exception{ "failed to parse json file." };
+
+		// caches written before the type index were a plain array of exports
+		const Json::Value& exports = root.isArray() ? root : root["exports"];
+
+		// hashes and types written by another canonicalizer would make exact lookups miss
+		bool canonical = root.isObject() && root["canonical_version"].asUInt() == CanonicalVersion;
+
+		for (auto& i : exports)
+		{
+			DeclarationDetails details{};
+			details.CFunction = i["declaration_details"]["c_function"].asBool();
+			details.Variable = i["declaration_details"]["variable"].asBool();
+			details.ConstructorFunction = i["declaration_details"]["constructor_function"].asBool();
+			details.DestructorFunction = i["declaration_details"]["destructor_function"].asBool();
+			details.Name = i["declaration_details"]["name"].asString();
+
+			for (auto& j : i["declaration_details"]["parentheses_pairs"])
+			{
+				details.ParenthesesPairs.push_back(j.asString());
+			}
+
+			m_exports.push_back(
+				{
+					i["ordinal"].asUInt64(),
+					i["rva"].asUInt(),
+					i["mangled_declaration"].asString(),
+					i["clear_declaration"].asString(),
+					details
+				}
+			);
+
+			if (canonical && i.isMember("canonical_hash"))
+				m_exports.back().CanonicalHash = i["canonical_hash"].asUInt64();
+			else
+				m_exports.back().CanonicalHash = HashCanonicalDeclaration(CanonicalizeDeclaration(m_exports.back().ClearDeclaration));
+		}
+
+		if (canonical && root.isMember("takes") && root.isMember("returns"))
+		{
+			ReadTypeIndex(root["takes"], m_takesIndex, m_exports.size());
+			ReadTypeIndex(root["returns"], m_returnsIndex, m_exports.size());
+		}
+		else
+			BuildTypeIndex(m_exports, m_takesIndex, m_returnsIndex);
+	}
+
+	void State::BuildDatabase()
+	{
+		m_database.Build(m_exports, m_takesIndex, m_returnsIndex);
+	}
+
+	void State::ParseDeclarationDetails(const std::string& declaration, DeclarationDetails& details)
+	{
+		// parse parentheses pairs
+		if (!SearchAllSubStrings(declaration, std::regex{ R"(\(([^()]*(\([^()]*\)[^()]*)*)\))" }, details.ParenthesesPairs))
+		{
+			// no space? 
+			if (!HaveSubString(declaration, " ") && 
+				!HaveSubString(declaration, "<") && 
+				!HaveSubString(declaration, ">") &&
+				!HaveSubString(declaration, ":"))
+			{
+				details.CFunction = true;
+			}					
+			else
+			{	
+				details.Variable = true; 
+				// the declaration still may be a variable (function pointer)
+				// like std::basic_string<char,std::char_traits<char>,std::allocator<char>> (* ExportedGlobalVariable)(std::basic_iostream<char,std::char_traits<char>> const&)
+			}
+		}
+
+		// extract export name
+		std::regex namePattern{ R"((::| )~?([\w<> +=+-/\*]+))" };
+		if (details.ParenthesesPairs.empty())
+		{
+			if (details.CFunction)
+				details.Name = declaration;
+			else
+			{
+				details.Name = RemoveAngleBrackets(declaration);
+				details.Name = FindLastMatch(details.Name, namePattern); // variable	
+			}
+				
+		}
+		else
+		{
+			if (declaration[declaration.find(details.ParenthesesPairs[0]) - 1] == ' ') // function pointer?
+			{
+				details.Variable = true;
+				// get from the first pair
+				size_t pos = details.ParenthesesPairs[0].find("* ");
+				details.Name = details.ParenthesesPairs[0].substr(pos + 2, details.ParenthesesPairs[0].size() - pos - 1);
+			}
+			else
+			{
+				size_t endPos = declaration.find(details.ParenthesesPairs[0]);
+				details.Name = RemoveAngleBrackets(declaration.substr(0, endPos));
+				details.Name = FindLastMatch(details.Name, namePattern);
+			}
+		}
+
+		details.Name = std::regex_replace(details.Name, std::regex{ R"(::)" }, "");
+		if (details.Name[0] == ' ')
+			details.Name = details.Name.substr(1);
+
+		// constructor function?
+		if (details.Name == "default_constructor_closure")
+			details.ConstructorFunction = true;
+
+		if (HaveSubString(details.Name, "~") || details.Name == "vbase_destructor")
+			details.DestructorFunction = true;
+
+	}
+
+	State::State(const std::filesystem::path& cacheDirectory, LogCallback log) :
+		m_cacheDirectory{ cacheDirectory },
+		m_log{ std::move(log) },
+		m_indexed{ false }
+	{
+	}
+
+	State::~State()
+	{
+		// m_indexer joins on destruction, let the user know why we are still running
+		if (m_indexer.joinable() && !m_indexed.load(std::memory_order_acquire))
+			Log("c2m is finishing the cache file...");
+	}
+
+	void State::Log(const std::string& message) const
+	{
+		if (m_log)
+			m_log(message);
+	}
+
+	Status State::LoadFile(const std::filesystem::path& path, bool lazy)
+	{
+		// the exports, the background indexer and every span handed out belong to the first module
+		if (!m_filePath.empty())
+		{
+			Log(std::format("{}: a State loads a single module, {} is already loaded.", path.string(), m_filePath.string()));
+			return Status::InvalidArgument;
+		}
+
+		try
+		{
+			if (!std::filesystem::exists(path))
+			{
+				Log(std::format("{}: file does not exist.", path.string()));
+				return Status::NotFound;
+			}
+
+			m_filePath = path;
+			m_fileName = path.filename();
+			m_cachePath = m_cacheDirectory / (m_fileName.string() + ".json");
+
+			// a cache of this exact build written by --index-dir wins over the per-name cache, which may come from
+			// another build of the same module. a broken manifest only means falling back to the per-name cache
+			std::filesystem::path manifestPath = m_cacheDirectory / "manifest.json";
+			if (std::filesystem::exists(manifestPath))
+			{
+				try
+				{
+					SymbolDatabase database{ manifestPath };
+					database.Load();
+
+					ModuleRecord record{};
+					if (database.Find(HashFile(path), record) && std::filesystem::exists(record.CachePath))
+						m_cachePath = record.CachePath;
+				}
+				catch (const std::exception& err)
+				{
+					Log(std::format("failed to read {}: {}", manifestPath.string(), err.what()));
+				}
+			}
+
+			if (!std::filesystem::exists(m_cachePath))
+			{
+				if (lazy)
+					GenerateCacheFileInBackground(); // builds the database itself once done
+				else
+				{
+					GenerateCacheFile();
+					BuildDatabase();
+				}
+			}
+			else
+			{
+				LoadExportsFromCacheFile();
+				BuildDatabase();
+			}
+		}
+		catch (const std::exception& err)
+		{
+			Log(std::format("{}: {}", path.string(), err.what()));
+			return Status::LoadFailed;
+		}
+		return Status::Ok;
+	}
+	
+	Lookup State::LookupClearDeclaration(const std::string& declaration)
+	{
+		Lookup lookup{};
+		lookup.Query = declaration;
+		lookup.Declaration = true;
+
+		DeclarationQuery query{};
+		Status status = ExportDatabase::ParseDeclarationQuery(declaration, query);
+		if (status != Status::Ok)
+		{
+			lookup.Error = std::format("\"{}\": {}", declaration, GetStatusString(status));
+			return lookup;
+		}
+
+		lookup.Details = query.Details;
+		lookup.Debug = RemoveAngleBrackets(query.Simplified);
+
+		if (IsFullyLoaded())
+		{
+			ExportSpan results{};
+			m_database.FindByDeclaration(query, results);
+			lookup.Results.assign(results.begin(), results.end());
+		}
+		else
+		{
+			// an exact hit on the canonical form wins, otherwise fall back to matching the name
+			std::vector<const Export*> exactResults{};
+
+			auto matches = [&](const Export& exp)
+				{
+					return query.Details.Name == exp.DeclarationDetails.Name &&
+						query.Details.CFunction == exp.DeclarationDetails.CFunction &&
+						query.Details.ConstructorFunction == exp.DeclarationDetails.ConstructorFunction &&
+						query.Details.DestructorFunction == exp.DeclarationDetails.DestructorFunction;
+				};
+
+			// only touch the exports we demangled ourselves, the indexer may be writing the others
+			std::vector<size_t> candidates{};
+			CollectCandidates(query.Details, candidates);
+
+			for (size_t i : candidates)
+			{
+				EnsureDemangled(i);
+				if (m_exports[i].CanonicalHash == query.CanonicalHash)
+					exactResults.push_back(&m_exports[i]);
+				if (matches(m_exports[i]))
+					lookup.Results.push_back(&m_exports[i]);
+			}
+
+			if (!exactResults.empty())
+				lookup.Results = std::move(exactResults);
+		}
+
+		if (lookup.Results.empty())
+			lookup.NotFound = std::format("mangled declaration of \"{}\" not found", declaration);
+		return lookup;
+	}
+
+	Lookup State::LookupAddress(uintptr_t baseAddress, uintptr_t address)
+	{
+		Lookup lookup = LookupRVA(address - baseAddress);
+		lookup.BaseAddress = baseAddress;
+		return lookup;
+	}
+
+	Lookup State::LookupRVA(uintptr_t rva)
+	{
+		Lookup lookup{};
+		lookup.Query = std::format("{:x}", rva);
+
+		if (IsFullyLoaded())
+		{
+			ExportSpan results{};
+			m_database.FindByRva(rva, results);
+			lookup.Results.assign(results.begin(), results.end());
+		}
+		else
+		{
+			for (size_t i = 0; i < m_exports.size(); i++) {
+				if (rva == m_exports[i].Rva)
+				{
+					EnsureDemangled(i);
+					lookup.Results.push_back(&m_exports[i]);
+				}
+			}
+		}
+
+		if (lookup.Results.empty())
+			lookup.NotFound = std::format("mangled declaration of rva \"{:x}\" not found", rva);
+		return lookup;
+	}
+
+	Lookup State::LookupType(const std::string& type, bool returns)
+	{
+		Lookup lookup{};
+		lookup.Query = type;
+
+		TypeQuery query{};
+		Status status = ExportDatabase::ParseTypeQuery(type, query);
+		if (status != Status::Ok)
+		{
+			lookup.Error = std::format("\"{}\": {}", type, GetStatusString(status));
+			return lookup;
+		}
+
+		if (IsFullyLoaded())
+		{
+			ExportSpan results{};
+			if (returns)
+				m_database.FindByReturnType(query, results);
+			else
+				m_database.FindByParameterType(query, results);
+			lookup.Results.assign(results.begin(), results.end());
+		}
+		else
+		{
+			// the index is built once every export is demangled, until then every export has to be looked at
+			const std::string& canonicalType = query.Canonical;
+			std::string returnType{};
+			std::vector<std::string> parameterTypes{};
+			for (size_t i = 0; i < m_exports.size(); i++)
+			{
+				EnsureDemangled(i);
+				if (!CanonicalizeSignature(m_exports[i].ClearDeclaration, returnType, parameterTypes))
+					continue;
+
+				if (returns ? returnType == canonicalType : std::find(parameterTypes.begin(), parameterTypes.end(), canonicalType) != parameterTypes.end())
+					lookup.Results.push_back(&m_exports[i]);
+			}
+		}
+
+		if (lookup.Results.empty())
+			lookup.NotFound = std::format("no export {} \"{}\"", returns ? "returns" : "takes", type);
+		return lookup;
+	}
+
+	Lookup State::LookupParameterType(const std::string& type)
+	{
+		return LookupType(type, false);
+	}
+
+	Lookup State::LookupReturnType(const std::string& type)
+	{
+		return LookupType(type, true);
+	}
+}
+
+
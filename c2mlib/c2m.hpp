@@ -0,0 +1,102 @@
+#pragma once
+
+#include <regex>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <filesystem>
+
+#include "database.hpp"
+
+namespace c2m
+{
+	// result of one query, resolving and printing are split so batches can resolve on several threads
+	struct Lookup
+	{
+		std::string Query;
+		uintptr_t BaseAddress = -1;
+
+		bool Declaration = false;
+		std::string Debug;
+		DeclarationDetails Details{};
+
+		std::vector<const Export*> Results;
+		std::string NotFound; // message when Results is empty
+		std::string Error; // set by callers that catch a failed lookup
+	};
+
+	// raw export table of a PE file, nothing is demangled yet
+	std::vector<Export> ReadExportTable(const std::filesystem::path& path);
+
+	class State
+	{
+	private:
+		std::filesystem::path m_cacheDirectory;
+		std::filesystem::path m_filePath;
+		std::filesystem::path m_fileName;
+		std::filesystem::path m_cachePath;
+		LogCallback m_log;
+
+		std::vector<Export> m_exports;
+
+		// parameter / return types, stored in the cache
+		TypeIndex m_takesIndex;
+		TypeIndex m_returnsIndex;
+
+		// views into m_exports, built once every export is demangled
+		ExportDatabase m_database;
+
+		// lazy mode: exports are demangled on demand until the background indexer is done
+		std::unique_ptr<std::once_flag[]> m_demangled;
+		std::atomic<bool> m_indexed;
+		std::jthread m_indexer; // keep last, must join before the exports go away
+	private:
+		void GenerateCacheFile();
+		void GenerateCacheFileInBackground();
+		void SaveToCacheFile();
+		void LoadExportTableFromPEFile();
+		void LoadExportsFromPEFile();
+		void LoadExportsFromCacheFile();
+		void BuildDatabase();
+	private:
+		void Log(const std::string& message) const;
+		void EnsureDemangled(size_t index);
+		void CollectCandidates(const DeclarationDetails& details, std::vector<size_t>& candidates);
+		Lookup LookupType(const std::string& type, bool returns);
+	public:
+		// declaration processing, no state involved
+		static std::string SimplifyDeclaration(const std::string& declaration);
+		static void ParseDeclarationDetails(const std::string& declaration, DeclarationDetails& details);
+		static void DemangleExport(Export& exp);
+		static void BuildTypeIndex(const std::vector<Export>& exports, TypeIndex& takes, TypeIndex& returns);
+		static void SaveExportsToCacheFile(const std::filesystem::path& path, const std::vector<Export>& exports);
+		static void SaveExportsToCacheFile(const std::filesystem::path& path, const std::vector<Export>& exports, const TypeIndex& takes, const TypeIndex& returns);
+	public:
+		// the cache directory is created on the first cache write
+		explicit State(const std::filesystem::path& cacheDirectory = "cache", LogCallback log = {});
+		~State();
+
+		// NotFound if the module does not exist, LoadFailed if it can't be read, the reason goes to the log.
+		// one module per State: any call after the one that found the file returns InvalidArgument
+		// a cache file that can't be written is logged and skipped, the module is loaded anyway
+		Status LoadFile(const std::filesystem::path& path, bool lazy = false);
+
+		// false while a lazy load is still demangling in background
+		bool IsFullyLoaded() const;
+		// nullptr until IsFullyLoaded(), a lazy load builds the database on the background thread
+		const ExportDatabase* GetDatabase() const { return IsFullyLoaded() ? &m_database : nullptr; }
+
+		// thread-safe, may demangle on demand in lazy mode and throw if undname fails
+		Lookup LookupClearDeclaration(const std::string& declaration);
+		Lookup LookupAddress(uintptr_t baseAddress, uintptr_t address);
+		Lookup LookupRVA(uintptr_t rva);
+		Lookup LookupParameterType(const std::string& type);
+		Lookup LookupReturnType(const std::string& type);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,576 @@
+#include "canonical.hpp"
+
+#include <array>
+#include <cctype>
+#include <vector>
+#include <unordered_map>
+
+namespace
+{
+	struct Token
+	{
+		std::string Text;
+		bool Word;
+	};
+
+	struct TemplateDefaults
+	{
+		size_t Required;
+		std::vector<std::string_view> Defaults; // $0, $1 refer to the leading arguments
+	};
+
+	bool IsWordChar(char c)
+	{
+		return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '@' || c == '?';
+	}
+
+	// builtin spellings made of several words, longest first
+	const std::array<std::pair<std::array<std::string_view, 4>, std::string_view>, 24> g_builtins{ {
+		{ { "unsigned", "long", "long", "int" }, "unsigned __int64" },
+		{ { "signed", "long", "long", "int" }, "__int64" },
+		{ { "unsigned", "long", "long" }, "unsigned __int64" },
+		{ { "unsigned", "short", "int" }, "unsigned short" },
+		{ { "unsigned", "long", "int" }, "unsigned long" },
+		{ { "signed", "short", "int" }, "short" },
+		{ { "signed", "long", "int" }, "long" },
+		{ { "signed", "long", "long" }, "__int64" },
+		{ { "long", "long", "int" }, "__int64" },
+		{ { "unsigned", "__int64" }, "unsigned __int64" },
+		{ { "signed", "__int64" }, "__int64" },
+		{ { "unsigned", "long" }, "unsigned long" },
+		{ { "unsigned", "short" }, "unsigned short" },
+		{ { "unsigned", "char" }, "unsigned char" },
+		{ { "unsigned", "int" }, "unsigned int" },
+		{ { "signed", "char" }, "signed char" },
+		{ { "signed", "short" }, "short" },
+		{ { "signed", "long" }, "long" },
+		{ { "signed", "int" }, "int" },
+		{ { "long", "long" }, "__int64" },
+		{ { "short", "int" }, "short" },
+		{ { "long", "int" }, "long" },
+		{ { "unsigned" }, "unsigned int" },
+		{ { "signed" }, "int" },
+	} };
+
+	// typedef -> canonical spelling, already expanded so a lookup never needs another pass.
+	// pointer sized typedefs (size_t, ptrdiff_t, ...) depend on the module and are left alone
+	const std::unordered_map<std::string, std::string>& AliasTable()
+	{
+		static const std::unordered_map<std::string, std::string> table = []()
+			{
+				std::unordered_map<std::string, std::string> aliases{
+					{ "int8_t", "signed char" },
+					{ "uint8_t", "unsigned char" },
+					{ "int16_t", "short" },
+					{ "uint16_t", "unsigned short" },
+					{ "int32_t", "int" },
+					{ "uint32_t", "unsigned int" },
+					{ "int64_t", "__int64" },
+					{ "uint64_t", "unsigned __int64" },
+				};
+
+				for (auto& [name, canonical] : std::vector<std::pair<std::string, std::string>>{ aliases.begin(), aliases.end() })
+					aliases.emplace("std::" + name, canonical);
+
+				const std::array<std::pair<std::string_view, std::string_view>, 5> characters{ {
+					{ "", "char" }, { "w", "wchar_t" }, { "u8", "char8_t" }, { "u16", "char16_t" }, { "u32", "char32_t" }
+				} };
+
+				for (auto& [prefix, character] : characters)
+				{
+					std::string traits = std::string{ "std::char_traits<" } + std::string{ character } + ">";
+					std::string allocator = std::string{ "std::allocator<" } + std::string{ character } + ">";
+
+					aliases.emplace("std::" + std::string{ prefix } + "string",
+						"std::basic_string<" + std::string{ character } + "," + traits + "," + allocator + ">");
+					aliases.emplace("std::" + std::string{ prefix } + "string_view",
+						"std::basic_string_view<" + std::string{ character } + "," + traits + ">");
+
+					// iostreams only exist for char and wchar_t
+					if (prefix.size() > 1)
+						continue;
+
+					for (std::string_view stream : { "ios", "streambuf", "istream", "ostream", "iostream", "filebuf", "ifstream", "ofstream", "fstream" })
+						aliases.emplace("std::" + std::string{ prefix } + std::string{ stream },
+							"std::basic_" + std::string{ stream } + "<" + std::string{ character } + "," + traits + ">");
+
+					for (std::string_view stream : { "stringbuf", "istringstream", "ostringstream", "stringstream" })
+						aliases.emplace("std::" + std::string{ prefix } + std::string{ stream },
+							"std::basic_" + std::string{ stream } + "<" + std::string{ character } + "," + traits + "," + allocator + ">");
+				}
+
+				return aliases;
+			}();
+		return table;
+	}
+
+	const std::unordered_map<std::string_view, TemplateDefaults>& DefaultsTable()
+	{
+		static const std::unordered_map<std::string_view, TemplateDefaults> table{
+			{ "std::basic_string", { 1, { "std::char_traits<$0>", "std::allocator<$0>" } } },
+			{ "std::basic_string_view", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_ios", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_streambuf", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_istream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_ostream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_iostream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_filebuf", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_ifstream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_ofstream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_fstream", { 1, { "std::char_traits<$0>" } } },
+			{ "std::basic_stringbuf", { 1, { "std::char_traits<$0>", "std::allocator<$0>" } } },
+			{ "std::basic_istringstream", { 1, { "std::char_traits<$0>", "std::allocator<$0>" } } },
+			{ "std::basic_ostringstream", { 1, { "std::char_traits<$0>", "std::allocator<$0>" } } },
+			{ "std::basic_stringstream", { 1, { "std::char_traits<$0>", "std::allocator<$0>" } } },
+			{ "std::istreambuf_iterator", { 1, { "std::char_traits<$0>" } } },
+			{ "std::ostreambuf_iterator", { 1, { "std::char_traits<$0>" } } },
+			{ "std::num_get", { 1, { "std::istreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::num_put", { 1, { "std::ostreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::money_get", { 1, { "std::istreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::money_put", { 1, { "std::ostreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::time_get", { 1, { "std::istreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::time_put", { 1, { "std::ostreambuf_iterator<$0,std::char_traits<$0>>" } } },
+			{ "std::vector", { 1, { "std::allocator<$0>" } } },
+			{ "std::list", { 1, { "std::allocator<$0>" } } },
+			{ "std::deque", { 1, { "std::allocator<$0>" } } },
+			{ "std::forward_list", { 1, { "std::allocator<$0>" } } },
+			{ "std::set", { 1, { "std::less<$0>", "std::allocator<$0>" } } },
+			{ "std::multiset", { 1, { "std::less<$0>", "std::allocator<$0>" } } },
+			{ "std::map", { 2, { "std::less<$0>", "std::allocator<std::pair<$0 const,$1>>" } } },
+			{ "std::multimap", { 2, { "std::less<$0>", "std::allocator<std::pair<$0 const,$1>>" } } },
+			{ "std::unordered_set", { 1, { "std::hash<$0>", "std::equal_to<$0>", "std::allocator<$0>" } } },
+			{ "std::unordered_map", { 2, { "std::hash<$0>", "std::equal_to<$0>", "std::allocator<std::pair<$0 const,$1>>" } } },
+			{ "std::unique_ptr", { 1, { "std::default_delete<$0>" } } },
+		};
+		return table;
+	}
+
+	void Emit(std::string& out, std::string_view text)
+	{
+		if (text.empty())
+			return;
+		if (!out.empty() && IsWordChar(out.back()) && IsWordChar(text.front()))
+			out.push_back(' ');
+		out.append(text);
+	}
+
+	std::vector<Token> Tokenize(std::string_view declaration)
+	{
+		std::vector<Token> tokens{};
+
+		for (size_t i = 0; i < declaration.size();)
+		{
+			char c = declaration[i];
+			if (std::isspace(static_cast<unsigned char>(c)))
+			{
+				i++;
+			}
+			else if (IsWordChar(c))
+			{
+				size_t begin = i;
+				while (i < declaration.size() && IsWordChar(declaration[i]))
+					i++;
+				tokens.push_back({ std::string{ declaration.substr(begin, i - begin) }, true });
+			}
+			else if (c == ':' && i + 1 < declaration.size() && declaration[i + 1] == ':')
+			{
+				tokens.push_back({ "::", false });
+				i += 2;
+			}
+			else
+			{
+				tokens.push_back({ std::string(1, c), false });
+				i++;
+			}
+		}
+
+		// merge "unsigned long long" and friends into one word so const reordering sees a single type
+		std::vector<Token> merged{};
+		for (size_t i = 0; i < tokens.size();)
+		{
+			bool found = false;
+			for (auto& [words, canonical] : g_builtins)
+			{
+				size_t count = 0;
+				while (count < words.size() && !words[count].empty())
+					count++;
+
+				if (i + count > tokens.size())
+					continue;
+
+				bool match = true;
+				for (size_t j = 0; j < count && match; j++)
+					match = tokens[i + j].Word && tokens[i + j].Text == words[j];
+
+				if (match)
+				{
+					merged.push_back({ std::string{ canonical }, true });
+					i += count;
+					found = true;
+					break;
+				}
+			}
+
+			if (!found)
+				merged.push_back(std::move(tokens[i++]));
+		}
+		return merged;
+	}
+
+	class Canonicalizer
+	{
+	private:
+		const std::vector<Token>& m_tokens;
+		size_t m_pos;
+	private:
+		bool At(std::string_view text) const
+		{
+			return m_pos < m_tokens.size() && !m_tokens[m_pos].Word && m_tokens[m_pos].Text == text;
+		}
+
+		bool AtWord() const
+		{
+			return m_pos < m_tokens.size() && m_tokens[m_pos].Word;
+		}
+
+		void ApplyDefaults(const std::string& name, std::vector<std::string>& args)
+		{
+			auto it = DefaultsTable().find(name);
+			if (it == DefaultsTable().end() || args.size() < it->second.Required)
+				return;
+
+			size_t total = it->second.Required + it->second.Defaults.size();
+			for (size_t i = args.size(); i < total; i++)
+			{
+				std::string value{ it->second.Defaults[i - it->second.Required] };
+				for (size_t pos = 0; (pos = value.find('$', pos)) != std::string::npos;)
+				{
+					std::string& arg = args[value[pos + 1] - '0'];
+					value.replace(pos, 2, arg);
+					pos += arg.size();
+				}
+				// "$0 const" needs another pass once $0 ends with '>'
+				args.push_back(c2m::CanonicalizeDeclaration(value));
+			}
+		}
+
+		std::string ParseName()
+		{
+			std::string text{};
+			std::string name{}; // qualified name without template arguments
+
+			while (m_pos < m_tokens.size())
+			{
+				if (At("::") || At("~"))
+				{
+					text += m_tokens[m_pos].Text;
+					name += m_tokens[m_pos].Text;
+					m_pos++;
+					continue;
+				}
+
+				if (!AtWord())
+					break;
+
+				const std::string& word = m_tokens[m_pos++].Text;
+				text += word;
+				name += word;
+
+				if (word == "operator")
+				{
+					if (At("(") || At("["))
+					{
+						text += m_tokens[m_pos++].Text;
+						if (m_pos < m_tokens.size())
+							text += m_tokens[m_pos++].Text;
+					}
+					else
+					{
+						while (m_pos < m_tokens.size() && !m_tokens[m_pos].Word &&
+							std::string_view{ "+-*/%^&|~!=<>," }.find(m_tokens[m_pos].Text) != std::string_view::npos)
+							text += m_tokens[m_pos++].Text;
+					}
+					break;
+				}
+
+				if (At("<"))
+				{
+					m_pos++;
+					std::vector<std::string> args{};
+					while (m_pos < m_tokens.size() && !At(">"))
+					{
+						args.push_back(ParseSequence(",", ">"));
+						if (At(","))
+							m_pos++;
+					}
+					if (At(">"))
+						m_pos++;
+
+					ApplyDefaults(name, args);
+
+					text += '<';
+					for (size_t i = 0; i < args.size(); i++)
+					{
+						if (i != 0)
+							text += ',';
+						text += args[i];
+					}
+					text += '>';
+				}
+				else
+				{
+					auto alias = AliasTable().find(name);
+					if (alias != AliasTable().end())
+						text = alias->second;
+				}
+
+				if (!At("::"))
+					break;
+			}
+			return text;
+		}
+
+		std::string ParseSequence(std::string_view separator, std::string_view terminator)
+		{
+			std::string out{};
+			std::string pendingQualifiers{};
+			bool haveType = false;
+
+			while (m_pos < m_tokens.size() && !At(separator) && !At(terminator))
+			{
+				const Token& token = m_tokens[m_pos];
+
+				if (token.Word && (token.Text == "class" || token.Text == "struct" || token.Text == "union" || token.Text == "enum" || token.Text == "typename"))
+				{
+					m_pos++;
+					continue;
+				}
+
+				// west const -> east const, undname prints "char const*"
+				if (token.Word && !haveType && (token.Text == "const" || token.Text == "volatile"))
+				{
+					Emit(pendingQualifiers, token.Text);
+					m_pos++;
+					continue;
+				}
+
+				if (token.Word || token.Text == "::" || token.Text == "~")
+				{
+					Emit(out, ParseName());
+					if (!haveType)
+					{
+						haveType = true;
+						Emit(out, pendingQualifiers);
+						pendingQualifiers.clear();
+					}
+					continue;
+				}
+
+				if (token.Text == "(")
+				{
+					m_pos++;
+					std::vector<std::string> elements{};
+					while (m_pos < m_tokens.size() && !At(")"))
+					{
+						elements.push_back(ParseSequence(",", ")"));
+						if (At(","))
+							m_pos++;
+					}
+					if (At(")"))
+						m_pos++;
+
+					// "(void)" and "()" are the same parameter list
+					if (elements.size() == 1 && elements[0] == "void")
+						elements.clear();
+
+					out += '(';
+					for (size_t i = 0; i < elements.size(); i++)
+					{
+						if (i != 0)
+							out += ',';
+						out += elements[i];
+					}
+					out += ')';
+					continue;
+				}
+
+				Emit(out, token.Text);
+				m_pos++;
+			}
+
+			Emit(out, pendingQualifiers);
+			return out;
+		}
+	public:
+		explicit Canonicalizer(const std::vector<Token>& tokens) :
+			m_tokens{ tokens },
+			m_pos{ 0 }
+		{
+		}
+
+		std::string Run()
+		{
+			// nothing terminates the top level, stray '>' or ',' are kept as they are
+			return ParseSequence("", "");
+		}
+	};
+
+	std::string_view Trim(std::string_view text)
+	{
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+			text.remove_prefix(1);
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+			text.remove_suffix(1);
+		return text;
+	}
+
+	// position of "operator" as a whole word, npos if the declaration is no operator
+	size_t FindOperator(std::string_view declaration)
+	{
+		for (size_t pos = declaration.find("operator"); pos != std::string_view::npos; pos = declaration.find("operator", pos + 1))
+		{
+			bool wordBegin = pos == 0 || !IsWordChar(declaration[pos - 1]);
+			bool wordEnd = pos + 8 == declaration.size() || !IsWordChar(declaration[pos + 8]);
+			if (wordBegin && wordEnd)
+				return pos;
+		}
+		return std::string_view::npos;
+	}
+
+	// first '(' outside of template arguments at or after begin
+	size_t FindOpenParenthesis(std::string_view declaration, size_t begin)
+	{
+		int depth = 0;
+		for (size_t i = begin; i < declaration.size(); i++)
+		{
+			if (declaration[i] == '<')
+				depth++;
+			else if (declaration[i] == '>')
+				depth--;
+			else if (declaration[i] == '(' && depth == 0)
+				return i;
+		}
+		return std::string_view::npos;
+	}
+}
+
+namespace c2m
+{
+	std::string CanonicalizeDeclaration(std::string_view declaration)
+	{
+		std::vector<Token> tokens = Tokenize(declaration);
+		return Canonicalizer{ tokens }.Run();
+	}
+
+	bool CanonicalizeSignature(std::string_view declaration, std::string& returnType, std::vector<std::string>& parameterTypes)
+	{
+		returnType.clear();
+		parameterTypes.clear();
+
+		// the operator symbol may contain '<', '>' or "()", skip it before looking for the parameter list
+		size_t nameEnd = FindOperator(declaration);
+		size_t open = std::string_view::npos;
+		bool conversion = false;
+
+		if (nameEnd == std::string_view::npos)
+		{
+			open = FindOpenParenthesis(declaration, 0);
+			nameEnd = open;
+		}
+		else
+		{
+			size_t symbol = nameEnd + 8;
+			if (declaration.substr(symbol, 2) == "()")
+				open = symbol + 2;
+			else if (symbol < declaration.size() && declaration[symbol] != ' ')
+			{
+				open = declaration.find_first_not_of("+-*/%^&|~!=<>,[]", symbol);
+				// operator<<<wchar_t,...>(...), the last '<' opened the template arguments
+				if (open != std::string_view::npos && declaration[open] != '(' && declaration[open - 1] == '<')
+					open = FindOpenParenthesis(declaration, open - 1);
+			}
+			else
+			{
+				// operator new / delete or a conversion operator, whose target type is its return type
+				open = FindOpenParenthesis(declaration, symbol);
+				std::string_view target = Trim(declaration.substr(symbol, open - symbol));
+				conversion = !target.starts_with("new") && !target.starts_with("delete");
+				if (conversion)
+					returnType = CanonicalizeDeclaration(target);
+			}
+		}
+
+		// no parameter list, or "(* name)(...)": a variable or a function pointer
+		if (open == std::string_view::npos || open >= declaration.size() || declaration[open] != '(' || open == 0 || declaration[open - 1] == ' ')
+		{
+			returnType.clear();
+			return false;
+		}
+
+		size_t close = open;
+		int parentheses = 0;
+		int brackets = 0;
+		size_t begin = open + 1;
+		for (; close < declaration.size(); close++)
+		{
+			char c = declaration[close];
+			if (c == '(')
+				parentheses++;
+			else if (c == ')' && --parentheses == 0)
+				break;
+			else if (c == '<')
+				brackets++;
+			else if (c == '>')
+				brackets--;
+			else if (c == ',' && parentheses == 1 && brackets == 0)
+			{
+				parameterTypes.push_back(CanonicalizeDeclaration(declaration.substr(begin, close - begin)));
+				begin = close + 1;
+			}
+		}
+
+		if (close == declaration.size())
+		{
+			returnType.clear();
+			parameterTypes.clear();
+			return false;
+		}
+
+		std::string last = CanonicalizeDeclaration(declaration.substr(begin, close - begin));
+		if (!parameterTypes.empty() || (!last.empty() && last != "void"))
+			parameterTypes.push_back(std::move(last));
+
+		if (conversion)
+			return true;
+
+		// the qualified name ends at the first space outside of template arguments
+		size_t nameBegin = nameEnd;
+		int depth = 0;
+		while (nameBegin > 0)
+		{
+			char c = declaration[nameBegin - 1];
+			if (c == '>')
+				depth++;
+			else if (c == '<')
+				depth--;
+			else if (c == ' ' && depth == 0)
+				break;
+			nameBegin--;
+		}
+
+		// constructors and destructors have no return type
+		returnType = CanonicalizeDeclaration(Trim(declaration.substr(0, nameBegin)));
+		return true;
+	}
+
+	uint64_t HashCanonicalDeclaration(std::string_view canonical)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : canonical)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace c2m
+{
+	// bump whenever CanonicalizeDeclaration spells something differently, hashes and type indices
+	// stored by another version are recomputed when the cache is loaded
+	inline constexpr uint32_t CanonicalVersion = 2;
+
+	// rewrites a simplified declaration into one spelling shared by windbg, ida and undname:
+	// typedefs are expanded (std::string, uint64_t, ...; pointer sized ones like size_t are kept), default template arguments are filled in,
+	// west const becomes east const and only the spaces between two words are kept
+	std::string CanonicalizeDeclaration(std::string_view declaration);
+
+	// canonical return type (empty for constructors and destructors) and parameter types of a simplified
+	// function declaration, false for variables and function pointers
+	bool CanonicalizeSignature(std::string_view declaration, std::string& returnType, std::vector<std::string>& parameterTypes);
+
+	// FNV-1a
+	uint64_t HashCanonicalDeclaration(std::string_view canonical);
+}
@@ -0,0 +1,247 @@
+#include "database.hpp"
+#include "c2m.hpp"
+#include "canonical.hpp"
+
+#include <tuple>
+#include <algorithm>
+
+namespace
+{
+	auto NameKey(const c2m::DeclarationDetails& details)
+	{
+		return std::tie(details.Name, details.CFunction, details.ConstructorFunction, details.DestructorFunction);
+	}
+}
+
+namespace c2m
+{
+	const char* GetStatusString(Status status)
+	{
+		switch (status)
+		{
+		case Status::Ok:
+			return "ok";
+		case Status::NotFound:
+			return "not found";
+		case Status::NotLoaded:
+			return "the module is not loaded yet";
+		case Status::InvalidArgument:
+			return "invalid argument";
+		case Status::Failed:
+			return "failed to parse the query";
+		case Status::LoadFailed:
+			return "failed to load the module";
+		}
+		return "unknown status";
+	}
+
+	ExportDatabase::ExportDatabase() :
+		m_built{ false }
+	{
+	}
+
+	void ExportDatabase::Build(std::span<const Export> exports, const TypeIndex& takes, const TypeIndex& returns)
+	{
+		m_exports = exports;
+
+		m_byRva.clear();
+		m_byRva.reserve(exports.size());
+		for (auto& exp : exports)
+			m_byRva.push_back(&exp);
+
+		m_byCanonicalHash = m_byRva;
+		m_byName = m_byRva;
+
+		// stable, equal keys keep the export order the old linear scans returned
+		std::stable_sort(m_byRva.begin(), m_byRva.end(), [](const Export* a, const Export* b) { return a->Rva < b->Rva; });
+		std::stable_sort(m_byCanonicalHash.begin(), m_byCanonicalHash.end(), [](const Export* a, const Export* b) { return a->CanonicalHash < b->CanonicalHash; });
+		std::stable_sort(m_byName.begin(), m_byName.end(), [](const Export* a, const Export* b) { return NameKey(a->DeclarationDetails) < NameKey(b->DeclarationDetails); });
+
+		auto resolve = [&](const TypeIndex& index, TypeTable& resolved)
+			{
+				resolved.clear();
+				resolved.reserve(index.size());
+				for (auto& [type, indices] : index)
+				{
+					std::vector<const Export*>& exportsOfType = resolved[type];
+					exportsOfType.reserve(indices.size());
+					for (size_t i : indices)
+						exportsOfType.push_back(&exports[i]);
+				}
+			};
+		resolve(takes, m_takes);
+		resolve(returns, m_returns);
+
+		m_built = true;
+	}
+
+	Status ExportDatabase::ParseDeclarationQuery(std::string_view declaration, DeclarationQuery& query) noexcept
+	{
+		if (declaration.empty())
+			return Status::InvalidArgument;
+
+		try
+		{
+			query.Simplified = State::SimplifyDeclaration(std::string{ declaration });
+			query.Details = DeclarationDetails{};
+			State::ParseDeclarationDetails(query.Simplified, query.Details);
+			query.CanonicalHash = HashCanonicalDeclaration(CanonicalizeDeclaration(query.Simplified));
+		}
+		catch (...)
+		{
+			return Status::Failed;
+		}
+		return Status::Ok;
+	}
+
+	Status ExportDatabase::FindByDeclaration(const DeclarationQuery& query, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		auto exactBegin = std::lower_bound(m_byCanonicalHash.begin(), m_byCanonicalHash.end(), query.CanonicalHash,
+			[](const Export* exp, uint64_t hash) { return exp->CanonicalHash < hash; });
+		auto exactEnd = std::upper_bound(exactBegin, m_byCanonicalHash.end(), query.CanonicalHash,
+			[](uint64_t hash, const Export* exp) { return hash < exp->CanonicalHash; });
+
+		if (exactBegin != exactEnd)
+		{
+			results = ExportSpan{ exactBegin, exactEnd };
+			return Status::Ok;
+		}
+
+		auto key = NameKey(query.Details);
+		auto nameBegin = std::lower_bound(m_byName.begin(), m_byName.end(), key,
+			[](const Export* exp, const auto& key) { return NameKey(exp->DeclarationDetails) < key; });
+		auto nameEnd = std::upper_bound(nameBegin, m_byName.end(), key,
+			[](const auto& key, const Export* exp) { return key < NameKey(exp->DeclarationDetails); });
+
+		results = ExportSpan{ nameBegin, nameEnd };
+		return results.empty() ? Status::NotFound : Status::Ok;
+	}
+
+	Status ExportDatabase::FindByDeclaration(std::string_view declaration, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		DeclarationQuery query{};
+		Status status = ParseDeclarationQuery(declaration, query);
+		if (status != Status::Ok)
+			return status;
+
+		return FindByDeclaration(query, results);
+	}
+
+	Status ExportDatabase::FindByRva(uintptr_t rva, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		auto begin = std::lower_bound(m_byRva.begin(), m_byRva.end(), rva, [](const Export* exp, uintptr_t rva) { return exp->Rva < rva; });
+		auto end = std::upper_bound(begin, m_byRva.end(), rva, [](uintptr_t rva, const Export* exp) { return rva < exp->Rva; });
+
+		results = ExportSpan{ begin, end };
+		return results.empty() ? Status::NotFound : Status::Ok;
+	}
+
+	Status ExportDatabase::FindNearest(uintptr_t rva, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		auto end = std::upper_bound(m_byRva.begin(), m_byRva.end(), rva, [](uintptr_t rva, const Export* exp) { return rva < exp->Rva; });
+		if (end == m_byRva.begin())
+			return Status::NotFound;
+
+		uintptr_t nearest = (*(end - 1))->Rva;
+		auto begin = std::lower_bound(m_byRva.begin(), end, nearest, [](const Export* exp, uintptr_t rva) { return exp->Rva < rva; });
+
+		results = ExportSpan{ begin, end };
+		return Status::Ok;
+	}
+
+	Status ExportDatabase::FindBatch(std::span<const uintptr_t> rvas, std::span<BatchResult> results) const noexcept
+	{
+		if (rvas.size() != results.size())
+			return Status::InvalidArgument;
+		if (!m_built)
+			return Status::NotLoaded;
+
+		for (size_t i = 0; i < rvas.size(); i++)
+			results[i].Result = FindByRva(rvas[i], results[i].Exports);
+		return Status::Ok;
+	}
+
+	Status ExportDatabase::ParseTypeQuery(std::string_view type, TypeQuery& query) noexcept
+	{
+		if (type.empty())
+			return Status::InvalidArgument;
+
+		try
+		{
+			query.Canonical = CanonicalizeDeclaration(State::SimplifyDeclaration(std::string{ type }));
+		}
+		catch (...)
+		{
+			return Status::Failed;
+		}
+		return Status::Ok;
+	}
+
+	Status ExportDatabase::FindByType(const TypeTable& index, const TypeQuery& query, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		auto hit = index.find(std::string_view{ query.Canonical });
+		if (hit == index.end())
+			return Status::NotFound;
+
+		results = hit->second;
+		return Status::Ok;
+	}
+
+	Status ExportDatabase::FindByParameterType(const TypeQuery& query, ExportSpan& results) const noexcept
+	{
+		return FindByType(m_takes, query, results);
+	}
+
+	Status ExportDatabase::FindByParameterType(std::string_view type, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		TypeQuery query{};
+		Status status = ParseTypeQuery(type, query);
+		if (status != Status::Ok)
+			return status;
+
+		return FindByParameterType(query, results);
+	}
+
+	Status ExportDatabase::FindByReturnType(const TypeQuery& query, ExportSpan& results) const noexcept
+	{
+		return FindByType(m_returns, query, results);
+	}
+
+	Status ExportDatabase::FindByReturnType(std::string_view type, ExportSpan& results) const noexcept
+	{
+		results = {};
+		if (!m_built)
+			return Status::NotLoaded;
+
+		TypeQuery query{};
+		Status status = ParseTypeQuery(type, query);
+		if (status != Status::Ok)
+			return status;
+
+		return FindByReturnType(query, results);
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+namespace c2m
+{
+	struct DeclarationDetails
+	{
+		bool CFunction;
+		bool Variable;
+		bool ConstructorFunction; // useless
+		bool DestructorFunction;
+
+		std::string Name;
+		std::vector<std::string> ParenthesesPairs;
+	};
+
+	struct Export
+	{
+		uintptr_t Ordinal;
+		uintptr_t Rva;
+		std::string MangledDeclaration;
+		std::string ClearDeclaration;
+		DeclarationDetails DeclarationDetails;
+		uint64_t CanonicalHash = 0; // hash of CanonicalizeDeclaration(ClearDeclaration)
+	};
+
+	// canonical type -> indices of the exports taking / returning it, in export order
+	using TypeIndex = std::unordered_map<std::string, std::vector<size_t>>;
+
+	// view into the export data of a database, valid as long as the database
+	using ExportSpan = std::span<const Export* const>;
+
+	enum class Status
+	{
+		Ok,
+		NotFound,
+		NotLoaded, // the database has not been built yet
+		InvalidArgument,
+		Failed, // the query could not be parsed
+		LoadFailed // State::LoadFile: the module or its cache could not be read
+	};
+
+	const char* GetStatusString(Status status);
+
+	// progress and non-fatal errors of the library, nothing is written anywhere unless one is set.
+	// may be called from background threads
+	using LogCallback = std::function<void(const std::string&)>;
+
+	// a declaration parsed once, so it can be looked up in any number of modules without allocating
+	struct DeclarationQuery
+	{
+		std::string Simplified;
+		DeclarationDetails Details;
+		uint64_t CanonicalHash;
+	};
+
+	// a type canonicalized once, for repeated --takes / --returns style lookups
+	struct TypeQuery
+	{
+		std::string Canonical;
+	};
+
+	struct BatchResult
+	{
+		Status Result;
+		ExportSpan Exports;
+	};
+
+	// lets the type tables be searched with a string_view, so a parsed type query does not allocate
+	struct TypeHash
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view type) const noexcept { return std::hash<std::string_view>{}(type); }
+	};
+
+	using TypeTable = std::unordered_map<std::string, std::vector<const Export*>, TypeHash, std::equal_to<>>;
+
+	// read-only lookup tables over a fully loaded export table.
+	// Build is not thread-safe, every Find* is const, takes no lock and allocates nothing once the query is parsed
+	class ExportDatabase
+	{
+	private:
+		std::span<const Export> m_exports;
+
+		std::vector<const Export*> m_byRva; // rva, then export order
+		std::vector<const Export*> m_byCanonicalHash; // canonical hash, then export order
+		std::vector<const Export*> m_byName; // name and kind, then export order
+
+		TypeTable m_takes;
+		TypeTable m_returns;
+		bool m_built;
+	private:
+		Status FindByType(const TypeTable& index, const TypeQuery& query, ExportSpan& results) const noexcept;
+	public:
+		ExportDatabase();
+
+		// the exports are not copied and must outlive the database
+		void Build(std::span<const Export> exports, const TypeIndex& takes, const TypeIndex& returns);
+
+		bool IsBuilt() const { return m_built; }
+		std::span<const Export> GetExports() const { return m_exports; }
+
+		static Status ParseDeclarationQuery(std::string_view declaration, DeclarationQuery& query) noexcept;
+
+		// exact canonical match first, otherwise every export with the same name and kind
+		Status FindByDeclaration(const DeclarationQuery& query, ExportSpan& results) const noexcept;
+		Status FindByDeclaration(std::string_view declaration, ExportSpan& results) const noexcept;
+
+		Status FindByRva(uintptr_t rva, ExportSpan& results) const noexcept;
+		// the exports at the highest rva not above rva, for addresses inside a function
+		Status FindNearest(uintptr_t rva, ExportSpan& results) const noexcept;
+		// results must be as long as rvas
+		Status FindBatch(std::span<const uintptr_t> rvas, std::span<BatchResult> results) const noexcept;
+
+		static Status ParseTypeQuery(std::string_view type, TypeQuery& query) noexcept;
+
+		Status FindByParameterType(const TypeQuery& query, ExportSpan& results) const noexcept;
+		Status FindByParameterType(std::string_view type, ExportSpan& results) const noexcept;
+		Status FindByReturnType(const TypeQuery& query, ExportSpan& results) const noexcept;
+		Status FindByReturnType(std::string_view type, ExportSpan& results) const noexcept;
+	};
+}
@@ -0,0 +1,178 @@
+#include "diff.hpp"
+#include "output.hpp"
+
+#include <fstream>
+#include <algorithm>
+
+namespace
+{
+	// ordinal-only exports have no name, join them by ordinal instead
+	std::string JoinKey(const c2m::Export& exp)
+	{
+		if (!exp.MangledDeclaration.empty())
+			return exp.MangledDeclaration;
+		return "#" + std::to_string(exp.Ordinal);
+	}
+
+	std::vector<std::pair<std::string, const c2m::Export*>> SortedKeys(const std::vector<c2m::Export>& exports)
+	{
+		std::vector<std::pair<std::string, const c2m::Export*>> keys{};
+		keys.reserve(exports.size());
+		for (auto& exp : exports)
+			keys.emplace_back(JoinKey(exp), &exp);
+
+		std::sort(keys.begin(), keys.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		return keys;
+	}
+}
+
+namespace c2m
+{
+	ExportDiff::ExportDiff() :
+		m_ambiguous{ 0 }
+	{
+	}
+
+	void ExportDiff::Compare(const std::filesystem::path& oldPath, const std::filesystem::path& newPath)
+	{
+		if (!std::filesystem::exists(oldPath) || !std::filesystem::exists(newPath))
+			throw std::exception{ "file does not exist." };
+
+		m_oldExports = ReadExportTable(oldPath);
+		m_newExports = ReadExportTable(newPath);
+
+		Join();
+		BuildRemapTable();
+	}
+
+	void ExportDiff::Join()
+	{
+		auto oldKeys = SortedKeys(m_oldExports);
+		auto newKeys = SortedKeys(m_newExports);
+
+		m_entries.clear();
+		m_entries.reserve(std::max(oldKeys.size(), newKeys.size()));
+
+		// merge join, both sides are sorted by key
+		size_t i = 0, j = 0;
+		while (i < oldKeys.size() || j < newKeys.size())
+		{
+			if (j == newKeys.size() || (i < oldKeys.size() && oldKeys[i].first < newKeys[j].first))
+			{
+				m_entries.push_back({ DiffStatus::Removed, oldKeys[i++].second, nullptr });
+			}
+			else if (i == oldKeys.size() || newKeys[j].first < oldKeys[i].first)
+			{
+				m_entries.push_back({ DiffStatus::Added, nullptr, newKeys[j++].second });
+			}
+			else
+			{
+				const Export* oldExport = oldKeys[i++].second;
+				const Export* newExport = newKeys[j++].second;
+				m_entries.push_back({ oldExport->Rva == newExport->Rva ? DiffStatus::Unchanged : DiffStatus::Moved, oldExport, newExport });
+			}
+		}
+	}
+
+	void ExportDiff::BuildRemapTable()
+	{
+		m_remap.clear();
+		m_ambiguous = 0;
+
+		for (auto& entry : m_entries)
+		{
+			if (entry.Old && entry.New)
+				m_remap.push_back({ entry.Old->Rva, entry.New->Rva });
+		}
+
+		std::sort(m_remap.begin(), m_remap.end(), [](const RvaRemap& a, const RvaRemap& b)
+			{
+				return a.OldRva != b.OldRva ? a.OldRva < b.OldRva : a.NewRva < b.NewRva;
+			});
+
+		// aliases of one old rva normally move together, drop the rvas whose names went different ways
+		std::vector<RvaRemap> unique{};
+		unique.reserve(m_remap.size());
+		for (size_t i = 0; i < m_remap.size();)
+		{
+			size_t end = i;
+			bool conflict = false;
+			while (end < m_remap.size() && m_remap[end].OldRva == m_remap[i].OldRva)
+			{
+				conflict |= m_remap[end].NewRva != m_remap[i].NewRva;
+				end++;
+			}
+
+			if (conflict)
+				m_ambiguous++;
+			else
+				unique.push_back(m_remap[i]);
+			i = end;
+		}
+		m_remap = std::move(unique);
+	}
+
+	bool ExportDiff::Remap(uintptr_t oldRva, uintptr_t& newRva) const
+	{
+		auto it = std::lower_bound(m_remap.begin(), m_remap.end(), oldRva, [](const RvaRemap& remap, uintptr_t rva) { return remap.OldRva < rva; });
+		if (it == m_remap.end() || it->OldRva != oldRva)
+			return false;
+
+		newRva = it->NewRva;
+		return true;
+	}
+
+	void ExportDiff::SaveRemapTable(const std::filesystem::path& path) const
+	{
+		std::FILE* file = std::fopen(path.string().c_str(), "wb");
+		if (!file)
+			throw std::exception{ "failed to open remap file." };
+
+		{
+			OutputWriter writer{ file };
+			for (auto& remap : m_remap)
+			{
+				writer.WriteHex(remap.OldRva);
+				writer.Write('\t');
+				writer.WriteHex(remap.NewRva);
+				writer.Write('\n');
+			}
+		}
+
+		std::fclose(file);
+	}
+
+	void ExportDiff::LoadRemapTable(const std::filesystem::path& path)
+	{
+		std::ifstream file{ path };
+		if (!file.is_open())
+			throw std::exception{ "failed to open remap file." };
+
+		m_oldExports.clear();
+		m_newExports.clear();
+		m_entries.clear();
+		m_remap.clear();
+		m_ambiguous = 0;
+
+		std::string line{};
+		while (std::getline(file, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (line.empty())
+				continue;
+
+			size_t tab = line.find('\t');
+			if (tab == std::string::npos)
+				throw std::exception{ "invalid remap file, expected \"<old rva>\\t<new rva>\" lines." };
+
+			RvaRemap remap{};
+			remap.OldRva = static_cast<uintptr_t>(std::stoull(line.substr(0, tab), nullptr, 16));
+			remap.NewRva = static_cast<uintptr_t>(std::stoull(line.substr(tab + 1), nullptr, 16));
+			m_remap.push_back(remap);
+		}
+
+		// Remap relies on the order, a hand edited table may not keep it
+		std::ranges::stable_sort(m_remap, {}, &RvaRemap::OldRva);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <filesystem>
+
+#include "c2m.hpp"
+
+namespace c2m
+{
+	enum class DiffStatus
+	{
+		Added,
+		Removed,
+		Moved,
+		Unchanged
+	};
+
+	struct DiffEntry
+	{
+		DiffStatus Status;
+		const Export* Old; // nullptr when added
+		const Export* New; // nullptr when removed
+	};
+
+	struct RvaRemap
+	{
+		uintptr_t OldRva;
+		uintptr_t NewRva;
+	};
+
+	// joins the export tables of two builds of a module by mangled name
+	class ExportDiff
+	{
+	private:
+		std::vector<Export> m_oldExports;
+		std::vector<Export> m_newExports;
+
+		std::vector<DiffEntry> m_entries; // sorted by mangled name
+		std::vector<RvaRemap> m_remap; // sorted by old rva
+		size_t m_ambiguous;
+	private:
+		void Join();
+		void BuildRemapTable();
+	public:
+		ExportDiff();
+
+		void Compare(const std::filesystem::path& oldPath, const std::filesystem::path& newPath);
+
+		const std::vector<DiffEntry>& GetEntries() const { return m_entries; }
+		const std::vector<RvaRemap>& GetRemapTable() const { return m_remap; }
+		size_t GetAmbiguousCount() const { return m_ambiguous; }
+
+		bool Remap(uintptr_t oldRva, uintptr_t& newRva) const;
+		// one "<old rva>\t<new rva>" line per entry, bare hex without 0x, sorted by old rva
+		void SaveRemapTable(const std::filesystem::path& path) const;
+		// reads a table written by SaveRemapTable back for Remap, without the two modules
+		void LoadRemapTable(const std::filesystem::path& path);
+	};
+}
@@ -0,0 +1,387 @@
+#include "indexer.hpp"
+#include "c2m.hpp"
+
+#include <cctype>
+#include <format>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <json/json.h>
+
+namespace
+{
+	// exports demangled by one task, small enough that a huge module is spread over every worker
+	constexpr size_t g_chunkSize = 32;
+
+	// the pool a worker thread belongs to, so nested submits land on the worker's own deque
+	thread_local c2m::WorkStealingPool* t_pool = nullptr;
+	thread_local size_t t_worker = 0;
+
+	struct ModuleJob
+	{
+		c2m::ModuleRecord Record;
+		std::vector<c2m::Export> Exports;
+		std::atomic<size_t> Remaining;
+		std::atomic<bool> Failed;
+	};
+}
+
+namespace c2m
+{
+	uint64_t HashFile(const std::filesystem::path& path)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		if (!file.is_open())
+			throw std::exception{ "failed to open file for hashing." };
+
+		uint64_t hash = 0xcbf29ce484222325ull;
+		std::vector<char> buffer(1 << 20);
+		while (file)
+		{
+			file.read(buffer.data(), buffer.size());
+			std::streamsize count = file.gcount();
+			for (std::streamsize i = 0; i < count; i++)
+			{
+				hash ^= static_cast<unsigned char>(buffer[i]);
+				hash *= 0x100000001b3ull;
+			}
+		}
+		return hash;
+	}
+
+	SymbolDatabase::SymbolDatabase(const std::filesystem::path& manifestPath) :
+		m_manifestPath{ manifestPath }
+	{
+	}
+
+	void SymbolDatabase::Load()
+	{
+		std::lock_guard lock{ m_mutex };
+		m_modules.clear();
+
+		// no manifest yet, nothing indexed
+		if (!std::filesystem::exists(m_manifestPath))
+			return;
+
+		std::ifstream file{ m_manifestPath };
+		if (!file.is_open())
+			throw std::exception{ "failed to open manifest file." };
+
+		Json::Reader reader;
+		Json::Value root;
+
+		if (!reader.parse(file, root, false))
+			throw std::exception{ "failed to parse manifest file." };
+
+		for (auto& i : root["modules"])
+		{
+			ModuleRecord record{
+				i["name"].asString(),
+				std::stoull(i["hash"].asString(), nullptr, 16),
+				i["cache"].asString()
+			};
+			m_modules[record.Hash] = std::move(record);
+		}
+	}
+
+	void SymbolDatabase::Save() const
+	{
+		Json::Value root;
+		root["modules"] = Json::Value{ Json::arrayValue };
+
+		{
+			std::lock_guard lock{ m_mutex };
+			for (auto& [hash, record] : m_modules)
+			{
+				Json::Value module;
+				module["name"] = record.Name;
+				module["hash"] = std::format("{:016x}", hash);
+				module["cache"] = record.CachePath.string();
+				root["modules"].append(module);
+			}
+		}
+
+		// write aside and swap, an interrupted run never leaves a torn manifest behind
+		std::filesystem::path temporary = m_manifestPath;
+		temporary += ".tmp";
+
+		std::ofstream file{ temporary };
+		if (!file.is_open())
+			throw std::exception{ "failed to open manifest file." };
+
+		file << root.toStyledString() << std::endl;
+		file.close();
+
+		std::filesystem::rename(temporary, m_manifestPath);
+	}
+
+	bool SymbolDatabase::Find(uint64_t hash, ModuleRecord& record) const
+	{
+		std::lock_guard lock{ m_mutex };
+
+		auto it = m_modules.find(hash);
+		if (it == m_modules.end())
+			return false;
+
+		record = it->second;
+		return true;
+	}
+
+	void SymbolDatabase::Add(const ModuleRecord& record)
+	{
+		std::lock_guard lock{ m_mutex };
+		m_modules[record.Hash] = record;
+	}
+
+	WorkStealingPool::WorkStealingPool(size_t threads) :
+		m_pending{ 0 },
+		m_queued{ 0 },
+		m_next{ 0 },
+		m_stop{ false }
+	{
+		threads = std::max<size_t>(threads, 1);
+
+		for (size_t i = 0; i < threads; i++)
+			m_workers.push_back(std::make_unique<Worker>());
+
+		for (size_t i = 0; i < threads; i++)
+			m_threads.emplace_back([this, i]() { Run(i); });
+	}
+
+	WorkStealingPool::~WorkStealingPool()
+	{
+		{
+			std::lock_guard lock{ m_mutex };
+			m_stop = true;
+		}
+		m_wakeup.notify_all();
+
+		// join here, the members the workers wait on are destroyed before m_threads
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	bool WorkStealingPool::TryPop(size_t index, std::function<void()>& task)
+	{
+		// newest own task first, it is still hot
+		{
+			Worker& self = *m_workers[index];
+			std::lock_guard lock{ self.Mutex };
+			if (!self.Tasks.empty())
+			{
+				task = std::move(self.Tasks.back());
+				self.Tasks.pop_back();
+				return true;
+			}
+		}
+
+		// steal the oldest task of somebody else
+		for (size_t i = 1; i < m_workers.size(); i++)
+		{
+			Worker& victim = *m_workers[(index + i) % m_workers.size()];
+			std::lock_guard lock{ victim.Mutex };
+			if (!victim.Tasks.empty())
+			{
+				task = std::move(victim.Tasks.front());
+				victim.Tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void WorkStealingPool::Run(size_t index)
+	{
+		t_pool = this;
+		t_worker = index;
+
+		while (true)
+		{
+			std::function<void()> task{};
+			if (TryPop(index, task))
+			{
+				m_queued.fetch_sub(1);
+				try { task(); }
+				catch (...) {}
+
+				if (m_pending.fetch_sub(1) == 1)
+				{
+					std::lock_guard lock{ m_mutex };
+					m_idle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock lock{ m_mutex };
+			if (m_stop)
+				return;
+
+			// a pop racing ahead of the matching Submit leaves the count below zero for a moment, hence > 0
+			m_wakeup.wait(lock, [&]() { return m_stop || m_queued.load() > 0; });
+		}
+	}
+
+	void WorkStealingPool::Submit(std::function<void()> task)
+	{
+		size_t index = (t_pool == this) ? t_worker : m_next.fetch_add(1) % m_workers.size();
+
+		m_pending.fetch_add(1);
+		{
+			Worker& worker = *m_workers[index];
+			std::lock_guard lock{ worker.Mutex };
+			worker.Tasks.push_back(std::move(task));
+		}
+
+		std::lock_guard lock{ m_mutex };
+		m_queued.fetch_add(1);
+		m_wakeup.notify_one();
+	}
+
+	void WorkStealingPool::Wait()
+	{
+		std::unique_lock lock{ m_mutex };
+		m_idle.wait(lock, [&]() { return m_pending.load() == 0; });
+	}
+
+	bool WorkStealingPool::WaitFor(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock lock{ m_mutex };
+		return m_idle.wait_for(lock, timeout, [&]() { return m_pending.load() == 0; });
+	}
+
+	DirectoryIndexer::DirectoryIndexer(SymbolDatabase& database, const std::filesystem::path& cacheDirectory, LogCallback log) :
+		m_database{ database },
+		m_cacheDirectory{ cacheDirectory },
+		m_log{ std::move(log) },
+		m_done{ 0 },
+		m_total{ 0 }
+	{
+	}
+
+	void DirectoryIndexer::Log(const std::string& message) const
+	{
+		if (m_log)
+			m_log(message);
+	}
+
+	void DirectoryIndexer::IndexModule(const std::filesystem::path& path)
+	{
+		std::string name = path.filename().string();
+		uint64_t hash = HashFile(path);
+
+		// resume: this build was indexed by an earlier run
+		ModuleRecord record{};
+		if (m_database.Find(hash, record) && std::filesystem::exists(record.CachePath))
+		{
+			Log(std::format("[{}/{}] {} (cached)", ++m_done, m_total, path.string()));
+			return;
+		}
+
+		auto job = std::make_shared<ModuleJob>();
+		job->Record = { name, hash, m_cacheDirectory / std::format("{}.{:016x}.json", name, hash) };
+		job->Failed = false;
+
+		try { job->Exports = ReadExportTable(path); }
+		catch (const std::exception&)
+		{
+			// not every dll exports something
+			Log(std::format("[{}/{}] {} (no exports)", ++m_done, m_total, path.string()));
+			return;
+		}
+
+		auto finish = [this, job, path]()
+			{
+				if (job->Failed)
+				{
+					Log(std::format("[{}/{}] {} (failed)", ++m_done, m_total, path.string()));
+					return;
+				}
+
+				try { State::SaveExportsToCacheFile(job->Record.CachePath, job->Exports); }
+				catch (const std::exception& err)
+				{
+					Log(std::format("[{}/{}] {} ({})", ++m_done, m_total, path.string(), err.what()));
+					return;
+				}
+				m_database.Add(job->Record);
+				Log(std::format("[{}/{}] {}", ++m_done, m_total, path.string()));
+			};
+
+		size_t chunks = (job->Exports.size() + g_chunkSize - 1) / g_chunkSize;
+		job->Remaining = chunks;
+
+		if (chunks == 0)
+		{
+			finish();
+			return;
+		}
+
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+		{
+			m_pool.Submit([job, chunk, finish]()
+				{
+					size_t end = std::min(job->Exports.size(), (chunk + 1) * g_chunkSize);
+					try
+					{
+						for (size_t i = chunk * g_chunkSize; i < end; i++)
+							State::DemangleExport(job->Exports[i]);
+					}
+					catch (const std::exception&)
+					{
+						job->Failed = true;
+					}
+
+					// the last chunk of a module writes its cache
+					if (job->Remaining.fetch_sub(1) == 1)
+						finish();
+				});
+		}
+	}
+
+	void DirectoryIndexer::Run(const std::filesystem::path& directory)
+	{
+		if (!std::filesystem::is_directory(directory))
+			throw std::exception{ "directory does not exist." };
+
+		std::filesystem::create_directories(m_cacheDirectory);
+
+		std::vector<std::pair<uintmax_t, std::filesystem::path>> modules{};
+
+		std::error_code error{};
+		for (auto it = std::filesystem::recursive_directory_iterator{ directory, std::filesystem::directory_options::skip_permission_denied, error };
+			it != std::filesystem::recursive_directory_iterator{}; it.increment(error))
+		{
+			if (error)
+				continue;
+
+			std::string extension = it->path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+			if (extension == ".dll" && it->is_regular_file(error))
+				modules.emplace_back(it->file_size(error), it->path());
+		}
+
+		// biggest modules first so they do not end up as the tail of the run. workers pop their newest task,
+		// so submit smallest first and every worker starts on the biggest module of its share
+		std::sort(modules.begin(), modules.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+		m_total = modules.size();
+		Log(std::format("c2m is indexing {} modules with {} threads...", m_total, std::max<unsigned>(std::thread::hardware_concurrency(), 1)));
+
+		for (auto& [size, path] : modules)
+		{
+			m_pool.Submit([this, path]()
+				{
+					// e.g. a module that can't be opened for hashing
+					try { IndexModule(path); }
+					catch (const std::exception& err) { Log(std::format("[{}/{}] {} ({})", ++m_done, m_total, path.string(), err.what())); }
+				});
+		}
+
+		// persist the manifest every few seconds so an interrupted run can resume
+		while (!m_pool.WaitFor(std::chrono::seconds{ 5 }))
+			m_database.Save();
+
+		m_database.Save();
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <deque>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "database.hpp"
+
+namespace c2m
+{
+	// FNV-1a over the file contents, identifies a module build independent of its path
+	uint64_t HashFile(const std::filesystem::path& path);
+
+	struct ModuleRecord
+	{
+		std::string Name;
+		uint64_t Hash;
+		std::filesystem::path CachePath;
+	};
+
+	// manifest of every indexed module: module name + content hash -> cache file
+	class SymbolDatabase
+	{
+	private:
+		std::filesystem::path m_manifestPath;
+		std::unordered_map<uint64_t, ModuleRecord> m_modules;
+		mutable std::mutex m_mutex;
+	public:
+		explicit SymbolDatabase(const std::filesystem::path& manifestPath);
+
+		void Load();
+		void Save() const;
+
+		bool Find(uint64_t hash, ModuleRecord& record) const;
+		void Add(const ModuleRecord& record);
+	};
+
+	// every worker owns a deque: it pops its own tasks from the back and steals from the front of the others
+	class WorkStealingPool
+	{
+	private:
+		struct Worker
+		{
+			std::mutex Mutex;
+			std::deque<std::function<void()>> Tasks;
+		};
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::vector<std::jthread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wakeup;
+		std::condition_variable m_idle;
+		std::atomic<size_t> m_pending;
+		std::atomic<ptrdiff_t> m_queued; // tasks in the deques, raised under m_mutex so a sleeping worker can't miss one
+		std::atomic<size_t> m_next;
+		bool m_stop;
+	private:
+		bool TryPop(size_t index, std::function<void()>& task);
+		void Run(size_t index);
+	public:
+		explicit WorkStealingPool(size_t threads = std::thread::hardware_concurrency());
+		~WorkStealingPool();
+
+		// tasks report their own errors, an exception escaping one is dropped
+		void Submit(std::function<void()> task);
+		void Wait();
+		bool WaitFor(std::chrono::milliseconds timeout); // true once idle
+	};
+
+	// indexes every dll below a directory into per-module caches plus the manifest
+	class DirectoryIndexer
+	{
+	private:
+		SymbolDatabase& m_database;
+		std::filesystem::path m_cacheDirectory;
+		LogCallback m_log; // called from every worker
+		WorkStealingPool m_pool;
+
+		std::atomic<size_t> m_done;
+		size_t m_total;
+	private:
+		void IndexModule(const std::filesystem::path& path);
+		void Log(const std::string& message) const;
+	public:
+		// the cache directory is created by Run
+		DirectoryIndexer(SymbolDatabase& database, const std::filesystem::path& cacheDirectory, LogCallback log = {});
+
+		void Run(const std::filesystem::path& directory);
+	};
+}
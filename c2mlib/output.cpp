@@ -0,0 +1,438 @@
+#include "output.hpp"
+#include "c2m.hpp"
+#include "diff.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace c2m
+{
+	OutputFormat ParseOutputFormat(std::string_view name)
+	{
+		if (name == "text")
+			return OutputFormat::Text;
+		if (name == "jsonl")
+			return OutputFormat::Jsonl;
+		if (name == "csv")
+			return OutputFormat::Csv;
+		if (name == "tsv")
+			return OutputFormat::Tsv;
+		throw std::exception{ "--format: expected one of jsonl, csv, tsv, text." };
+	}
+
+	OutputWriter::OutputWriter(std::FILE* file, size_t capacity) :
+		m_file{ file },
+		m_buffer{ std::make_unique<char[]>(capacity) },
+		m_capacity{ capacity },
+		m_size{ 0 }
+	{
+	}
+
+	OutputWriter::~OutputWriter()
+	{
+		Flush();
+	}
+
+	void OutputWriter::Flush()
+	{
+		if (m_size != 0)
+		{
+			std::fwrite(m_buffer.get(), 1, m_size, m_file);
+			m_size = 0;
+		}
+		std::fflush(m_file);
+	}
+
+	void OutputWriter::Write(char c)
+	{
+		if (m_size == m_capacity)
+			Flush();
+		m_buffer[m_size++] = c;
+	}
+
+	void OutputWriter::Write(std::string_view string)
+	{
+		if (m_size + string.size() > m_capacity)
+		{
+			Flush();
+			// larger than the whole buffer, skip the copy
+			if (string.size() > m_capacity)
+			{
+				std::fwrite(string.data(), 1, string.size(), m_file);
+				return;
+			}
+		}
+		std::memcpy(m_buffer.get() + m_size, string.data(), string.size());
+		m_size += string.size();
+	}
+
+	void OutputWriter::WriteDecimal(uint64_t value)
+	{
+		char digits[20];
+		auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+		Write(std::string_view{ digits, static_cast<size_t>(end - digits) });
+	}
+
+	void OutputWriter::WriteHex(uint64_t value, int width, bool upperCase)
+	{
+		const char* table = upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+		char digits[16];
+		int count = 0;
+
+		do
+		{
+			digits[15 - count++] = table[value & 0xF];
+			value >>= 4;
+		} while (value != 0);
+
+		while (count < width && count < 16)
+			digits[15 - count++] = '0';
+
+		Write(std::string_view{ digits + 16 - count, static_cast<size_t>(count) });
+	}
+
+	OutputSink::OutputSink(std::FILE* file, OutputFormat format, bool color) :
+		m_writer{ file },
+		m_format{ format },
+		m_color{ color && format == OutputFormat::Text },
+		m_headerWritten{ false }
+	{
+	}
+
+	void OutputSink::WriteColor(const char* color)
+	{
+		if (m_color)
+			m_writer.Write(color);
+	}
+
+	void OutputSink::WriteField(std::string_view field)
+	{
+		switch (m_format)
+		{
+		case OutputFormat::Jsonl:
+			m_writer.Write('"');
+			for (char c : field)
+			{
+				switch (c)
+				{
+				case '"': m_writer.Write("\\\""); break;
+				case '\\': m_writer.Write("\\\\"); break;
+				case '\n': m_writer.Write("\\n"); break;
+				case '\r': m_writer.Write("\\r"); break;
+				case '\t': m_writer.Write("\\t"); break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						m_writer.Write("\\u00");
+						m_writer.WriteHex(static_cast<unsigned char>(c), 2);
+					}
+					else
+						m_writer.Write(c);
+				}
+			}
+			m_writer.Write('"');
+			break;
+		case OutputFormat::Csv:
+			// declarations are full of commas, always quote
+			m_writer.Write('"');
+			for (char c : field)
+			{
+				if (c == '"')
+					m_writer.Write('"');
+				m_writer.Write(c);
+			}
+			m_writer.Write('"');
+			break;
+		case OutputFormat::Tsv:
+			for (char c : field)
+				m_writer.Write((c == '\t' || c == '\n' || c == '\r') ? ' ' : c);
+			break;
+		default:
+			m_writer.Write(field);
+			break;
+		}
+	}
+
+	void OutputSink::WriteHeader(std::string_view columns)
+	{
+		m_headerWritten = true;
+		if (m_format != OutputFormat::Csv && m_format != OutputFormat::Tsv)
+			return;
+
+		for (char c : columns)
+			m_writer.Write((c == ',' && m_format == OutputFormat::Tsv) ? '\t' : c);
+		m_writer.Write('\n');
+	}
+
+	void OutputSink::Flush()
+	{
+		m_writer.Flush();
+	}
+
+	void OutputSink::WriteSearchTarget(std::string_view debug, const DeclarationDetails& details)
+	{
+		// only meaningful for humans
+		if (m_format != OutputFormat::Text)
+			return;
+
+		m_writer.Write("Debug:               ");
+		m_writer.Write(debug);
+		m_writer.Write("\nName:                ");
+		m_writer.Write(details.Name);
+		m_writer.Write("\nCFunction:           ");
+		m_writer.Write(details.CFunction ? "YES" : "NO");
+		m_writer.Write("\nConstructorFunction: ");
+		m_writer.Write(details.ConstructorFunction ? "YES" : "NO");
+		m_writer.Write("\nDestructorFunction:  ");
+		m_writer.Write(details.DestructorFunction ? "YES" : "NO");
+		m_writer.Write("\n\n");
+	}
+
+	void OutputSink::WriteExport(const Export& exp, uintptr_t address)
+	{
+		std::string_view type = exp.DeclarationDetails.Variable ? "Variable" : (exp.DeclarationDetails.CFunction ? "C Function" : "C++ Function");
+
+		if (!m_headerWritten)
+			WriteHeader("ordinal,address,type,mangled_declaration,clear_declaration");
+
+		switch (m_format)
+		{
+		case OutputFormat::Jsonl:
+			m_writer.Write("{\"ordinal\":");
+			m_writer.WriteDecimal(exp.Ordinal);
+			m_writer.Write(",\"address\":\"0x");
+			m_writer.WriteHex(address);
+			m_writer.Write("\",\"type\":");
+			WriteField(type);
+			m_writer.Write(",\"mangled_declaration\":");
+			WriteField(exp.MangledDeclaration);
+			m_writer.Write(",\"clear_declaration\":");
+			WriteField(exp.ClearDeclaration);
+			m_writer.Write("}\n");
+			break;
+		case OutputFormat::Csv:
+		case OutputFormat::Tsv:
+		{
+			char separator = m_format == OutputFormat::Csv ? ',' : '\t';
+			m_writer.WriteDecimal(exp.Ordinal);
+			m_writer.Write(separator);
+			m_writer.Write("0x");
+			m_writer.WriteHex(address);
+			m_writer.Write(separator);
+			WriteField(type);
+			m_writer.Write(separator);
+			WriteField(exp.MangledDeclaration);
+			m_writer.Write(separator);
+			WriteField(exp.ClearDeclaration);
+			m_writer.Write('\n');
+			break;
+		}
+		default:
+			WriteColor(COLOR_BLUE);
+			m_writer.WriteDecimal(exp.Ordinal);
+			WriteColor(COLOR_MAGENTA);
+			m_writer.Write('\t');
+			m_writer.WriteHex(address, sizeof(uintptr_t) * 2, true);
+			WriteColor(COLOR_CYAN);
+			m_writer.Write('\t');
+			m_writer.Write(type);
+			WriteColor(COLOR_END);
+			m_writer.Write('\t');
+			m_writer.Write(exp.MangledDeclaration);
+			m_writer.Write("\n+-----------------------------------------------");
+			WriteColor(COLOR_YELLOW);
+			m_writer.Write(exp.ClearDeclaration);
+			m_writer.Write("\n\n");
+			WriteColor(COLOR_END);
+			break;
+		}
+	}
+
+	void OutputSink::WriteNotFound(std::string_view message)
+	{
+		// keep machine-readable streams clean, report misses on stderr
+		if (m_format != OutputFormat::Text)
+		{
+			std::fwrite(message.data(), 1, message.size(), stderr);
+			std::fputc('\n', stderr);
+			return;
+		}
+
+		WriteColor(COLOR_RED);
+		m_writer.Write(message);
+		WriteColor(COLOR_END);
+		m_writer.Write('\n');
+	}
+
+	void OutputSink::WriteLookup(const Lookup& lookup, const std::function<void(const Export*)>& outputer)
+	{
+		if (!lookup.Error.empty())
+		{
+			Flush();
+			std::fwrite(lookup.Error.data(), 1, lookup.Error.size(), stderr);
+			std::fputc('\n', stderr);
+			return;
+		}
+
+		if (lookup.Declaration && !outputer)
+			WriteSearchTarget(lookup.Debug, lookup.Details);
+
+		if (lookup.Results.empty())
+		{
+			WriteNotFound(lookup.NotFound);
+			return;
+		}
+
+		for (const Export* exp : lookup.Results)
+		{
+			if (outputer)
+			{
+				// the script prints on its own, keep the order of our buffered output
+				Flush();
+				outputer(exp);
+			}
+			else
+				WriteExport(*exp, (lookup.BaseAddress == -1) ? exp->Rva : lookup.BaseAddress + exp->Rva);
+		}
+	}
+
+	void OutputSink::WriteDiffEntry(const DiffEntry& entry)
+	{
+		std::string_view status{};
+		const char* color = COLOR_END;
+		switch (entry.Status)
+		{
+		case DiffStatus::Added: status = "added"; color = COLOR_GREEN; break;
+		case DiffStatus::Removed: status = "removed"; color = COLOR_RED; break;
+		case DiffStatus::Moved: status = "moved"; color = COLOR_YELLOW; break;
+		default: status = "unchanged"; break;
+		}
+
+		const Export& exp = entry.New ? *entry.New : *entry.Old;
+
+		if (!m_headerWritten)
+			WriteHeader("status,old_rva,new_rva,mangled_declaration");
+
+		switch (m_format)
+		{
+		case OutputFormat::Jsonl:
+			m_writer.Write("{\"status\":");
+			WriteField(status);
+			m_writer.Write(",\"old_rva\":");
+			if (entry.Old)
+			{
+				m_writer.Write("\"0x");
+				m_writer.WriteHex(entry.Old->Rva);
+				m_writer.Write('"');
+			}
+			else
+				m_writer.Write("null");
+			m_writer.Write(",\"new_rva\":");
+			if (entry.New)
+			{
+				m_writer.Write("\"0x");
+				m_writer.WriteHex(entry.New->Rva);
+				m_writer.Write('"');
+			}
+			else
+				m_writer.Write("null");
+			m_writer.Write(",\"mangled_declaration\":");
+			WriteField(exp.MangledDeclaration);
+			m_writer.Write("}\n");
+			break;
+		case OutputFormat::Csv:
+		case OutputFormat::Tsv:
+		{
+			char separator = m_format == OutputFormat::Csv ? ',' : '\t';
+			m_writer.Write(status);
+			m_writer.Write(separator);
+			if (entry.Old)
+			{
+				m_writer.Write("0x");
+				m_writer.WriteHex(entry.Old->Rva);
+			}
+			m_writer.Write(separator);
+			if (entry.New)
+			{
+				m_writer.Write("0x");
+				m_writer.WriteHex(entry.New->Rva);
+			}
+			m_writer.Write(separator);
+			WriteField(exp.MangledDeclaration);
+			m_writer.Write('\n');
+			break;
+		}
+		default:
+			WriteColor(color);
+			m_writer.Write(status);
+			WriteColor(COLOR_MAGENTA);
+			m_writer.Write('\t');
+			if (entry.Old)
+				m_writer.WriteHex(entry.Old->Rva, sizeof(uintptr_t) * 2, true);
+			else
+				m_writer.Write("----------------");
+			m_writer.Write(" -> ");
+			if (entry.New)
+				m_writer.WriteHex(entry.New->Rva, sizeof(uintptr_t) * 2, true);
+			else
+				m_writer.Write("----------------");
+			WriteColor(COLOR_END);
+			m_writer.Write('\t');
+			m_writer.Write(exp.MangledDeclaration);
+			m_writer.Write('\n');
+			break;
+		}
+	}
+
+	void OutputSink::WriteDiffSummary(size_t added, size_t removed, size_t moved, size_t unchanged)
+	{
+		if (m_format != OutputFormat::Text)
+			return;
+
+		m_writer.Write("\nadded: ");
+		m_writer.WriteDecimal(added);
+		m_writer.Write(", removed: ");
+		m_writer.WriteDecimal(removed);
+		m_writer.Write(", moved: ");
+		m_writer.WriteDecimal(moved);
+		m_writer.Write(", unchanged: ");
+		m_writer.WriteDecimal(unchanged);
+		m_writer.Write('\n');
+	}
+
+	void OutputSink::WriteRemap(uintptr_t oldRva, uintptr_t newRva)
+	{
+		if (!m_headerWritten)
+			WriteHeader("old_rva,new_rva");
+
+		switch (m_format)
+		{
+		case OutputFormat::Jsonl:
+			m_writer.Write("{\"old_rva\":\"0x");
+			m_writer.WriteHex(oldRva);
+			m_writer.Write("\",\"new_rva\":\"0x");
+			m_writer.WriteHex(newRva);
+			m_writer.Write("\"}\n");
+			break;
+		case OutputFormat::Csv:
+		case OutputFormat::Tsv:
+			m_writer.Write("0x");
+			m_writer.WriteHex(oldRva);
+			m_writer.Write(m_format == OutputFormat::Csv ? ',' : '\t');
+			m_writer.Write("0x");
+			m_writer.WriteHex(newRva);
+			m_writer.Write('\n');
+			break;
+		default:
+			WriteColor(COLOR_MAGENTA);
+			m_writer.WriteHex(oldRva, sizeof(uintptr_t) * 2, true);
+			WriteColor(COLOR_END);
+			m_writer.Write(" -> ");
+			WriteColor(COLOR_GREEN);
+			m_writer.WriteHex(newRva, sizeof(uintptr_t) * 2, true);
+			WriteColor(COLOR_END);
+			m_writer.Write('\n');
+			break;
+		}
+	}
+}
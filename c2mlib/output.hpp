@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <string_view>
+
+#define COLOR_RED "\033[0m\033[1;31m"
+#define COLOR_GREEN "\033[0m\033[1;32m"
+#define COLOR_YELLOW "\033[1m\033[1;33m"
+#define COLOR_BLUE "\033[0m\033[1;34m"
+#define COLOR_MAGENTA "\033[0m\033[1;35m"
+#define COLOR_CYAN "\033[0m\033[1;36m"
+#define COLOR_END "\033[0m"
+
+namespace c2m
+{
+	struct Export;
+	struct DeclarationDetails;
+	struct DiffEntry;
+	struct Lookup;
+
+	enum class OutputFormat
+	{
+		Text,
+		Jsonl,
+		Csv,
+		Tsv
+	};
+
+	OutputFormat ParseOutputFormat(std::string_view name);
+
+	// one large buffer in front of fwrite, numbers are formatted by hand (no iostream, no locale)
+	class OutputWriter
+	{
+	private:
+		std::FILE* m_file;
+		std::unique_ptr<char[]> m_buffer;
+		size_t m_capacity;
+		size_t m_size;
+	public:
+		explicit OutputWriter(std::FILE* file, size_t capacity = 1 << 20);
+		~OutputWriter();
+
+		OutputWriter(const OutputWriter&) = delete;
+		OutputWriter& operator=(const OutputWriter&) = delete;
+
+		void Flush();
+		void Write(char c);
+		void Write(std::string_view string);
+		void WriteDecimal(uint64_t value);
+		void WriteHex(uint64_t value, int width = 0, bool upperCase = false);
+	};
+
+	class OutputSink
+	{
+	private:
+		OutputWriter m_writer;
+		OutputFormat m_format;
+		bool m_color;
+		bool m_headerWritten;
+	private:
+		void WriteColor(const char* color);
+		void WriteField(std::string_view field);
+		void WriteHeader(std::string_view columns);
+	public:
+		OutputSink(std::FILE* file, OutputFormat format, bool color);
+
+		OutputFormat GetFormat() const { return m_format; }
+
+		void Flush();
+		void WriteSearchTarget(std::string_view debug, const DeclarationDetails& details);
+		void WriteExport(const Export& exp, uintptr_t address);
+		void WriteNotFound(std::string_view message);
+		// error, search target, misses and results of one query, outputer replaces the export rows
+		void WriteLookup(const Lookup& lookup, const std::function<void(const Export*)>& outputer);
+
+		void WriteDiffEntry(const DiffEntry& entry);
+		void WriteDiffSummary(size_t added, size_t removed, size_t moved, size_t unchanged);
+		void WriteRemap(uintptr_t oldRva, uintptr_t newRva);
+	};
+}
@@ -1,6 +1,4 @@
-﻿import libpe;
-
-#include <string>
+﻿#include <string>
 #include <string_view>
 #include <format>
 #include <vector>
@@ -8,6 +6,7 @@
 #include <fstream>
 #include <filesystem>
 #include <regex>
+#include <optional>
 
 #include <argparse/argparse.hpp>
 #include <json/json.h>
@@ -15,6 +14,10 @@
 #include <pybind11/embed.h>
 
 #include "c2m.hpp"
+#include "diff.hpp"
+#include "indexer.hpp"
+#include "output.hpp"
+#include "pipeline.hpp"
 
 enum _C2MMODE
 {
@@ -24,15 +27,20 @@ enum _C2MMODE
 	VIRTUAL_ADDRESS,
 	FILE_VIRTUAL_ADDRESS,
 	RVA,
-	FILE_RVA
+	FILE_RVA,
+	DIFF,
+	FILE_DIFF,
+	FILE_REMAP,
+	INDEX_DIRECTORY,
+	TAKES,
+	RETURNS
 };
 
 void InitializeCommandLine(argparse::ArgumentParser& program, int argc, char* argv[])
 {
 	program.add_argument("--src")
-		.required()
 		.nargs(1)
-		.help("the source PE file");
+		.help("the source PE file [required unless --diff or --index-dir is used]");
 
 	program.add_argument("-d", "--declaration")
 		.default_value("")
@@ -66,12 +74,98 @@ void InitializeCommandLine(argparse::ArgumentParser& program, int argc, char* ar
 		.nargs(0, 1)
 		.help("the rva of the function/variable");
 
+	program.add_argument("--takes")
+		.default_value("")
+		.nargs(1)
+		.help("list the functions with a parameter of this type");
+
+	program.add_argument("--returns")
+		.default_value("")
+		.nargs(1)
+		.help("list the functions returning this type");
+
+	program.add_argument("--format")
+		.default_value("text")
+		.nargs(1)
+		.help("output format: jsonl, csv, tsv or text");
+
+	program.add_argument("--no-color")
+		.default_value(false)
+		.implicit_value(true)
+		.help("disable ANSI colors in text output");
+
+	program.add_argument("--lazy")
+		.default_value(false)
+		.implicit_value(true)
+		.help("answer queries before the cache is generated, the cache is filled in background");
+
+	program.add_argument("--diff")
+		.nargs(2)
+		.help("compare the exports of two versions of a module: --diff <old> <new>, used with --file to translate old rvas");
+
+	program.add_argument("--remap")
+		.default_value("")
+		.nargs(1)
+		.help("with --diff, write the old rva -> new rva table to this file; without, translate the rvas of --file with a saved table");
+
+	program.add_argument("--index-dir")
+		.default_value("")
+		.nargs(1)
+		.help("index every dll below the directory into the cache, interrupted runs resume");
+
 	try { program.parse_args(argc, argv); }
 	catch (const std::exception& err) { throw err; }
 }
 
 _C2MMODE GetC2mMode(argparse::ArgumentParser& program)
 {
+	if (program.is_used("--diff"))
+	{
+		if (program.is_used("--src") || program.is_used("--declaration") || program.is_used("--va") || program.is_used("--base") || program.is_used("--rva"))
+			throw std::exception{ "--diff can only be used with --file, --remap and output options." };
+		if (program.is_used("--script"))
+			throw std::exception{ "--diff & --script can't be used together." };
+		if (program.is_used("--takes") || program.is_used("--returns") || program.is_used("--index-dir") || program.is_used("--lazy"))
+			throw std::exception{ "--diff can only be used with --file, --remap and output options." };
+		return program.is_used("--file") ? FILE_DIFF : DIFF;
+	}
+
+	if (program.is_used("--index-dir"))
+	{
+		if (program.is_used("--src") || program.is_used("--file") || program.is_used("--declaration") || program.is_used("--va") || program.is_used("--rva"))
+			throw std::exception{ "--index-dir can't be used with queries." };
+		if (program.is_used("--base") || program.is_used("--takes") || program.is_used("--returns") || program.is_used("--script") || program.is_used("--remap"))
+			throw std::exception{ "--index-dir can't be used with queries." };
+		if (program.is_used("--lazy") || program.is_used("--format") || program.is_used("--no-color"))
+			throw std::exception{ "--index-dir only writes the cache, --lazy and output options don't apply." };
+		return INDEX_DIRECTORY;
+	}
+
+	if (program.is_used("--remap"))
+	{
+		if (program.is_used("--src") || program.is_used("--declaration") || program.is_used("--va") || program.is_used("--base") || program.is_used("--rva"))
+			throw std::exception{ "--remap can only be used with --diff, --file and output options." };
+		if (program.is_used("--script"))
+			throw std::exception{ "--remap & --script can't be used together." };
+		if (program.is_used("--takes") || program.is_used("--returns") || program.is_used("--lazy"))
+			throw std::exception{ "--remap can only be used with --diff, --file and output options." };
+		if (!program.is_used("--file"))
+			throw std::exception{ "--remap needs --diff to write a table or --file to translate with one." };
+		return FILE_REMAP;
+	}
+
+	if (!program.is_used("--src"))
+		throw std::exception{ "--src: required." };
+
+	if (program.is_used("--takes") || program.is_used("--returns"))
+	{
+		if (program.is_used("--takes") && program.is_used("--returns"))
+			throw std::exception{ "--takes & --returns can't be used together." };
+		if (program.is_used("--file") || program.is_used("--script") || program.is_used("--declaration") || program.is_used("--va") || program.is_used("--base") || program.is_used("--rva"))
+			throw std::exception{ "--takes & --returns can't be used with other queries." };
+		return program.is_used("--takes") ? TAKES : RETURNS;
+	}
+
 	if(!program.is_used("--file") && program.is_used("--script"))
 		throw std::exception{ "--file & --script must be used together." };
 
@@ -116,21 +210,15 @@ _C2MMODE GetC2mMode(argparse::ArgumentParser& program)
 	return UNKNOWN;
 }
 
-void ReadFileLines(const std::filesystem::path& path, std::vector<std::string>& lines)
+std::ifstream OpenInputFile(const std::filesystem::path& path)
 {
 	std::ifstream file{ path };
 	if (!file.is_open())
 		throw std::exception{ (std::string("failed to open file \"") + path.string() + "\"").c_str()};
-	std::string line{};
-	
-	while (std::getline(file, line)) 
-	{
-		lines.push_back(line);
-	}
-
-	file.close();
+	return file;
 }
 
+// only touched by the script stage, c2m_input runs there with the GIL held
 bool skipLine = false;
 
 PYBIND11_EMBEDDED_MODULE(c2m, m) {
@@ -154,9 +242,11 @@ PYBIND11_EMBEDDED_MODULE(c2m, m) {
 
 int main(int argc, char* argv[])
 {
-	std::filesystem::create_directory("cache");
+	const std::filesystem::path cacheDirectory{ "./cache" };
+	// progress goes to stderr, stdout is kept clean for machine-readable formats
+	c2m::LogCallback log = [](const std::string& message) { std::println(std::cerr, "{}", message); };
 
-	c2m::State state{};
+	c2m::State state{ cacheDirectory, log };
 	argparse::ArgumentParser program{ "clear2mangled" };
 	_C2MMODE mode{ UNKNOWN };
 
@@ -170,6 +260,10 @@ int main(int argc, char* argv[])
 		InitializeCommandLine(program, argc, argv);
 		mode = GetC2mMode(program);
 
+		c2m::OutputFormat format = c2m::ParseOutputFormat(program.get<std::string>("--format"));
+		bool color = !program.get<bool>("--no-color");
+		c2m::OutputSink sink{ stdout, format, color };
+
 		bool useScriptOutput = false;
 
 		if (program.is_used("--script"))
@@ -206,29 +300,36 @@ int main(int argc, char* argv[])
 			}
 		}
 	
-		state.LoadFile(program.get<std::string>("--src"));
+		// the reason of a failed load is already logged
+		if (mode != DIFF && mode != FILE_DIFF && mode != FILE_REMAP && mode != INDEX_DIRECTORY &&
+			state.LoadFile(program.get<std::string>("--src"), program.get<bool>("--lazy")) != c2m::Status::Ok)
+			return -1;
 
 
-		std::vector<std::string> lines{};
-		auto processLines = [&](std::function<void(const std::string&)> operation)
+		// lines are read, run through c2m_input, looked up by every core and printed back in input order
+		auto processLines = [&]<typename T>(std::function<T(const std::string&)> resolve, std::function<void(T&)> emit)
 			{
-				ReadFileLines(program.get<std::string>("--file"), lines);
-				for (auto& line : lines)
-				{
-					skipLine = false;
-					std::string result{ line };
-					if (program.is_used("--script"))
-						result = inputFunction(line).cast<std::string>();
-					
-					if (skipLine)
-						continue;
-
-					operation(result);
-				}
+				std::ifstream file = OpenInputFile(program.get<std::string>("--file"));
+
+				std::function<bool(std::string&)> transform{};
+				if (program.is_used("--script"))
+					transform = [&](std::string& line)
+					{
+						pybind11::gil_scoped_acquire acquire{};
+						skipLine = false;
+						// rethrow as a plain exception, a pybind11 error must not outlive the GIL
+						try { line = inputFunction(line).cast<std::string>(); }
+						catch (const std::exception& err) { throw std::runtime_error{ err.what() }; }
+						return !skipLine;
+					};
+
+				// the stages take the GIL only around python calls
+				pybind11::gil_scoped_release release{};
+				c2m::RunLinePipeline<T>(file, transform, resolve, emit);
 			};
-		std::function<void(c2m::Export*)> outputer;
+		std::function<void(const c2m::Export*)> outputer;
 		if (useScriptOutput)
-			outputer = [&](c2m::Export* exp) 
+			outputer = [&](const c2m::Export* exp) 
 			{ 
 				pybind11::object dd = c2mmodule.attr("declaration_details")(exp->DeclarationDetails.CFunction,
 																			exp->DeclarationDetails.Variable,
@@ -245,38 +346,129 @@ int main(int argc, char* argv[])
 				catch (const std::exception& err) { std::println(std::cerr, "{}", err.what()); return -1; }
 				return 0;
 			};
+		std::function<void(c2m::Lookup&)> printLookup = [&](c2m::Lookup& lookup)
+			{
+				if (!useScriptOutput)
+				{
+					sink.WriteLookup(lookup, outputer);
+					return;
+				}
+				pybind11::gil_scoped_acquire acquire{};
+				sink.WriteLookup(lookup, outputer);
+			};
+		auto printQuery = [&](std::function<c2m::Lookup()> query)
+			{
+				c2m::Lookup lookup{};
+				try { lookup = query(); }
+				catch (const std::exception& err) { lookup.Error = err.what(); }
+				sink.WriteLookup(lookup, outputer);
+			};
 
 		switch (mode)
 		{
 		case DECLARATION:
-			state.PrintMangledNameByClearDeclaration(program.get<std::string>("--declaration"));
+			printQuery([&]() { return state.LookupClearDeclaration(program.get<std::string>("--declaration")); });
 			break;
 		case VIRTUAL_ADDRESS:
-			state.PrintMangledNameByAddress(program.get<uintptr_t>("--base"), std::stoll(program.get<std::string>("--va"), nullptr, 16));
+		{
+			uintptr_t address = std::stoll(program.get<std::string>("--va"), nullptr, 16);
+			printQuery([&]() { return state.LookupAddress(program.get<uintptr_t>("--base"), address); });
 			break;
+		}
 		case RVA:
-			state.PrintMangledNameByRVA(program.get<uintptr_t>("--rva"));
+			printQuery([&]() { return state.LookupRVA(program.get<uintptr_t>("--rva")); });
+			break;
+		case TAKES:
+			printQuery([&]() { return state.LookupParameterType(program.get<std::string>("--takes")); });
+			break;
+		case RETURNS:
+			printQuery([&]() { return state.LookupReturnType(program.get<std::string>("--returns")); });
 			break;
 		case FILE_DECLARATION:
-			processLines([&](const std::string& str)
-				{						
-					state.PrintMangledNameByClearDeclaration(str, outputer);
-				});
+			processLines(std::function<c2m::Lookup(const std::string&)>{ [&](const std::string& str)
+				{
+					try { return state.LookupClearDeclaration(str); }
+					catch (const std::exception& err) { return c2m::Lookup{ .Error = err.what() }; }
+				} }, printLookup);
 			break;
 		case FILE_VIRTUAL_ADDRESS:
-			processLines([&](const std::string& str)
+		{
+			uintptr_t base = program.get<uintptr_t>("--base");
+			processLines(std::function<c2m::Lookup(const std::string&)>{ [&, base](const std::string& str)
 				{
 					uintptr_t address = std::stoll(str, nullptr, 16);
-					state.PrintMangledNameByAddress(program.get<uintptr_t>("--base"), address, outputer);
-				});
+					try { return state.LookupAddress(base, address); }
+					catch (const std::exception& err) { return c2m::Lookup{ .Error = err.what() }; }
+				} }, printLookup);
 			break;
+		}
 		case FILE_RVA:
-			processLines([&](const std::string& str)
+			processLines(std::function<c2m::Lookup(const std::string&)>{ [&](const std::string& str)
 				{
 					uintptr_t rva = std::stoll(str, nullptr, 16);
-					state.PrintMangledNameByRVA(rva, outputer);
-				});
+					try { return state.LookupRVA(rva); }
+					catch (const std::exception& err) { return c2m::Lookup{ .Error = err.what() }; }
+				} }, printLookup);
 			break;
+		case DIFF:
+		case FILE_DIFF:
+		case FILE_REMAP:
+		{
+			c2m::ExportDiff diff{};
+			if (mode == FILE_REMAP)
+				diff.LoadRemapTable(program.get<std::string>("--remap"));
+			else
+			{
+				auto paths = program.get<std::vector<std::string>>("--diff");
+				diff.Compare(paths[0], paths[1]);
+
+				if (program.is_used("--remap"))
+					diff.SaveRemapTable(program.get<std::string>("--remap"));
+			}
+
+			if (mode == DIFF)
+			{
+				size_t counts[4]{};
+				for (auto& entry : diff.GetEntries())
+				{
+					counts[static_cast<size_t>(entry.Status)]++;
+					if (entry.Status != c2m::DiffStatus::Unchanged)
+						sink.WriteDiffEntry(entry);
+				}
+				sink.WriteDiffSummary(counts[0], counts[1], counts[2], counts[3]);
+			}
+			else
+			{
+				using Remapped = std::pair<uintptr_t, std::optional<uintptr_t>>;
+				processLines(std::function<Remapped(const std::string&)>{ [&](const std::string& str)
+					{
+						Remapped remapped{ static_cast<uintptr_t>(std::stoll(str, nullptr, 16)), std::nullopt };
+						uintptr_t newRva{};
+						if (diff.Remap(remapped.first, newRva))
+							remapped.second = newRva;
+						return remapped;
+					} }, std::function<void(Remapped&)>{ [&](Remapped& remapped)
+					{
+						if (remapped.second)
+							sink.WriteRemap(remapped.first, *remapped.second);
+						else
+							sink.WriteNotFound(std::format("rva \"{:x}\" has no counterpart in the new module", remapped.first));
+					} });
+			}
+
+			if (diff.GetAmbiguousCount() != 0)
+				std::println(std::cerr, "{} old rva(s) map to several new rvas and were left out of the remap table", diff.GetAmbiguousCount());
+			break;
+		}
+		case INDEX_DIRECTORY:
+		{
+			c2m::SymbolDatabase database{ cacheDirectory / "manifest.json" };
+			database.Load();
+
+			c2m::DirectoryIndexer indexer{ database, cacheDirectory, log };
+			indexer.Run(program.get<std::string>("--index-dir"));
+			break;
+		}
 		default:
 			std::println(std::cerr, "unknown c2m mode.");
 			return -1;
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <istream>
+#include <semaphore>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace c2m
+{
+	// blocking fifo between two pipeline stages, Push waits while the queue is full
+	template <typename T>
+	class BoundedQueue
+	{
+	private:
+		std::deque<T> m_items;
+		size_t m_capacity;
+		bool m_closed;
+
+		std::mutex m_mutex;
+		std::condition_variable m_notFull;
+		std::condition_variable m_notEmpty;
+	public:
+		explicit BoundedQueue(size_t capacity) :
+			m_capacity{ capacity },
+			m_closed{ false }
+		{
+		}
+
+		bool Push(T item)
+		{
+			std::unique_lock lock{ m_mutex };
+			m_notFull.wait(lock, [&]() { return m_closed || m_items.size() < m_capacity; });
+			if (m_closed)
+				return false;
+
+			m_items.push_back(std::move(item));
+			m_notEmpty.notify_one();
+			return true;
+		}
+
+		// false once the queue is closed and drained
+		bool Pop(T& item)
+		{
+			std::unique_lock lock{ m_mutex };
+			m_notEmpty.wait(lock, [&]() { return m_closed || !m_items.empty(); });
+			if (m_items.empty())
+				return false;
+
+			item = std::move(m_items.front());
+			m_items.pop_front();
+			m_notFull.notify_one();
+			return true;
+		}
+
+		// producers are done, consumers still drain what is left
+		void Close()
+		{
+			std::lock_guard lock{ m_mutex };
+			m_closed = true;
+			m_notFull.notify_all();
+			m_notEmpty.notify_all();
+		}
+
+		// something failed, drop everything and wake every stage up
+		void Abort()
+		{
+			std::lock_guard lock{ m_mutex };
+			m_closed = true;
+			m_items.clear();
+			m_notFull.notify_all();
+			m_notEmpty.notify_all();
+		}
+	};
+
+	// read -> transform (own thread, optional) -> resolve (worker pool) -> emit (calling thread, input order).
+	// transform returns false to skip a line. the first exception of any stage stops the pipeline and is rethrown
+	template <typename T>
+	void RunLinePipeline(std::istream& input,
+		std::function<bool(std::string&)> transform,
+		std::function<T(const std::string&)> resolve,
+		std::function<void(T&)> emit,
+		size_t workers = std::max(std::thread::hardware_concurrency(), 1u))
+	{
+		struct Line
+		{
+			size_t Index;
+			std::string Text;
+			bool Skip;
+		};
+
+		struct Resolved
+		{
+			size_t Index;
+			bool Skip;
+			T Value;
+		};
+
+		constexpr size_t capacity = 1024;
+		// lines between the reader and the emitter, bounds the reorder buffer behind one slow lookup
+		constexpr ptrdiff_t window = 4096;
+
+		BoundedQueue<Line> transformQueue{ capacity };
+		BoundedQueue<Line> resolveQueue{ capacity };
+		BoundedQueue<Resolved> emitQueue{ capacity };
+		std::counting_semaphore<> inFlight{ window };
+
+		std::mutex failureMutex{};
+		std::exception_ptr failure{};
+		std::atomic<bool> aborted{ false };
+
+		auto fail = [&](std::exception_ptr error)
+			{
+				{
+					std::lock_guard lock{ failureMutex };
+					if (failure)
+						return;
+					failure = error;
+				}
+				aborted = true;
+				transformQueue.Abort();
+				resolveQueue.Abort();
+				emitQueue.Abort();
+				inFlight.release(window);
+			};
+
+		std::jthread reader{ [&]()
+			{
+				BoundedQueue<Line>& next = transform ? transformQueue : resolveQueue;
+				try
+				{
+					std::string text{};
+					size_t index = 0;
+					while (!aborted && std::getline(input, text))
+					{
+						inFlight.acquire();
+						if (!next.Push({ index++, std::move(text), false }))
+							break;
+					}
+				}
+				catch (...) { fail(std::current_exception()); }
+				next.Close();
+			} };
+
+		std::jthread transformer{};
+		if (transform)
+		{
+			transformer = std::jthread{ [&]()
+				{
+					try
+					{
+						Line line{};
+						while (transformQueue.Pop(line))
+						{
+							line.Skip = !transform(line.Text);
+							if (!resolveQueue.Push(std::move(line)))
+								break;
+						}
+					}
+					catch (...) { fail(std::current_exception()); }
+					resolveQueue.Close();
+				} };
+		}
+
+		std::atomic<size_t> running{ workers };
+		std::vector<std::jthread> resolvers{};
+		for (size_t i = 0; i < workers; i++)
+		{
+			resolvers.emplace_back([&]()
+				{
+					try
+					{
+						Line line{};
+						while (resolveQueue.Pop(line))
+						{
+							Resolved resolved{ line.Index, line.Skip, T{} };
+							if (!line.Skip)
+								resolved.Value = resolve(line.Text);
+							if (!emitQueue.Push(std::move(resolved)))
+								break;
+						}
+					}
+					catch (...) { fail(std::current_exception()); }
+
+					if (running.fetch_sub(1) == 1)
+						emitQueue.Close();
+				});
+		}
+
+		// results arrive out of order, hold them back until the next line in input order is there
+		try
+		{
+			std::map<size_t, Resolved> pending{};
+			size_t next = 0;
+			Resolved resolved{};
+			while (emitQueue.Pop(resolved))
+			{
+				size_t index = resolved.Index;
+				pending.emplace(index, std::move(resolved));
+
+				for (auto it = pending.find(next); it != pending.end(); it = pending.find(++next))
+				{
+					if (!it->second.Skip)
+						emit(it->second.Value);
+					pending.erase(it);
+					inFlight.release();
+				}
+			}
+		}
+		catch (...) { fail(std::current_exception()); }
+
+		reader.join();
+		if (transformer.joinable())
+			transformer.join();
+		for (auto& resolver : resolvers)
+			resolver.join();
+
+		if (failure)
+			std::rethrow_exception(failure);
+	}
+}